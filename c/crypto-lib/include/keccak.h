@@ -9,8 +9,23 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define KECCAK256_HASH_SIZE 32
 
+/**
+ * @brief Incremental Keccak-256 state
+ *
+ * Plain data: copying a context mid-stream forks it, so the digest of a
+ * prefix can be taken without ending the stream.
+ */
+typedef struct {
+    uint64_t state[25];     /**< Sponge state (internal representation) */
+    size_t position;        /**< Bytes absorbed into the current block */
+} keccak256_ctx;
+
 /**
  * @brief Compute Keccak-256 hash
  * @param input Input data
@@ -20,7 +35,55 @@
 void keccak256(const uint8_t *input, size_t input_len, uint8_t *output);
 
 /**
- * @brief Convert bytes to hex string
+ * @brief Start a new Keccak-256 hash
+ * @param ctx Context to (re)initialize
+ */
+void keccak256_init(keccak256_ctx *ctx);
+
+/**
+ * @brief Absorb more input; any split of the message gives the same digest
+ * @param ctx Context from keccak256_init
+ * @param input Input data
+ * @param input_len Input data length
+ */
+void keccak256_update(keccak256_ctx *ctx, const uint8_t *input, size_t input_len);
+
+/**
+ * @brief Finish the hash; call keccak256_init before reusing ctx
+ * @param ctx Context from keccak256_init
+ * @param output Output buffer (must be 32 bytes)
+ */
+void keccak256_final(keccak256_ctx *ctx, uint8_t *output);
+
+/**
+ * @brief Compute Keccak-256 of several independent messages
+ *
+ * Hashes 8 (AVX-512) or 4 (AVX2) messages at a time in parallel, chosen at
+ * runtime, and the rest one by one. Messages may have different lengths;
+ * the batch is fastest when lengths within each group are similar.
+ *
+ * @param inputs Message pointers, count entries
+ * @param input_lens Message lengths, count entries
+ * @param count Number of messages
+ * @param outputs Output buffer, count * 32 bytes; digest i at i * 32
+ */
+void keccak256_batch(const uint8_t *const *inputs, const size_t *input_lens,
+                     size_t count, uint8_t *outputs);
+
+/**
+ * @brief Number of messages keccak256_batch hashes in parallel on this CPU
+ * @return 8, 4, or 1 without SIMD support
+ */
+int keccak256_batch_width(void);
+
+/**
+ * @brief Keccak-f[1600] permutation
+ * @param state 25 lanes, lane (x, y) at state[x + 5 * y]
+ */
+void keccak_f1600(uint64_t state[25]);
+
+/**
+ * @brief Convert bytes to lowercase hex string
  * @param bytes Input bytes
  * @param len Byte length
  * @param hex_out Output hex string (must be len*2+1 bytes)
@@ -29,6 +92,10 @@ void bytes_to_hex(const uint8_t *bytes, size_t len, char *hex_out);
 
 /**
  * @brief Convert hex string to bytes
+ *
+ * Accepts upper and lower case digits only; anything else, including a
+ * "0x" prefix, is an error. On error the contents of bytes are unspecified.
+ *
  * @param hex Input hex string
  * @param bytes Output bytes
  * @param len Expected byte length
@@ -36,4 +103,33 @@ void bytes_to_hex(const uint8_t *bytes, size_t len, char *hex_out);
  */
 int hex_to_bytes(const char *hex, uint8_t *bytes, size_t len);
 
+/**
+ * @brief Convert hex characters of known length to bytes (no terminator needed)
+ * @param hex Input hex characters
+ * @param hex_len Number of characters (must be even)
+ * @param bytes Output bytes (hex_len / 2)
+ * @return 0 on success, -1 on error
+ */
+int hex_decode(const char *hex, size_t hex_len, uint8_t *bytes);
+
+/**
+ * @brief Convert bytes to hex in place, e.g. a packed array of hashes at once
+ * @param buffer len bytes of input, with room for len * 2 characters of
+ *        output (not terminated)
+ * @param len Byte length
+ */
+void bytes_to_hex_inplace(uint8_t *buffer, size_t len);
+
+/**
+ * @brief Convert hex to bytes in place; the bytes land at the start of buffer
+ * @param buffer Hex characters
+ * @param hex_len Number of characters (must be even)
+ * @return 0 on success, -1 on error
+ */
+int hex_to_bytes_inplace(char *buffer, size_t hex_len);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* KECCAK_H */
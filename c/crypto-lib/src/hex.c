@@ -0,0 +1,277 @@
+/**
+ * @file hex.c
+ * @brief Hex encoding and decoding
+ *
+ * Both directions have a scalar path and SSSE3/AVX2 kernels picked at
+ * runtime. Decoding validates strictly (only 0-9, a-f, A-F) without a
+ * branch per character: invalid characters are OR-ed into an error value
+ * that is checked once at the end.
+ */
+
+#include "keccak.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEX_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+static const char hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
+// Nibble value of a character, or 0x100 if it isn't a hex digit
+static const uint16_t hex_values[256] = {
+#define X 0x100
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X
+#undef X
+};
+
+// 2 for AVX2, 1 for SSSE3, 0 for neither
+static int hex_simd_level(void) {
+#ifdef HEX_X86_SIMD
+    // Detected on first use and kept as level + 1, so 0 means not yet;
+    // callers racing on it all store the same value
+    static int cached;
+    int level = __atomic_load_n(&cached, __ATOMIC_RELAXED);
+    if (level == 0) {
+        __builtin_cpu_init();
+        level = __builtin_cpu_supports("avx2") ? 3 : __builtin_cpu_supports("ssse3") ? 2 : 1;
+        __atomic_store_n(&cached, level, __ATOMIC_RELAXED);
+    }
+    return level - 1;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Encoding runs from the last byte to the first and decoding from the
+ * first character to the last. Either way no write lands on input that
+ * hasn't been read yet, which is what makes the in-place variants work.
+ */
+
+static void hex_encode_scalar(const uint8_t *bytes, size_t len, char *hex_out) {
+    for (size_t i = len; i-- > 0;) {
+        uint8_t byte = bytes[i];
+        hex_out[2 * i] = hex_digits[byte >> 4];
+        hex_out[2 * i + 1] = hex_digits[byte & 0x0f];
+    }
+}
+
+// Returns non-zero if any character was invalid
+static unsigned hex_decode_scalar(const char *hex, size_t len, uint8_t *bytes) {
+    unsigned error = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned high = hex_values[(uint8_t)hex[2 * i]];
+        unsigned low = hex_values[(uint8_t)hex[2 * i + 1]];
+        error |= high | low;
+        bytes[i] = (uint8_t)((high << 4) | (low & 0x0f));
+    }
+    return error & 0x100;
+}
+
+#ifdef HEX_X86_SIMD
+
+// 16/32 bytes to 32/64 characters: split into nibbles, map each through a
+// 16-entry table with one shuffle, then interleave high and low nibbles.
+// The kernels return how many bytes they converted.
+
+__attribute__((target("ssse3")))
+static size_t hex_encode_ssse3(const uint8_t *bytes, size_t len, char *hex_out) {
+    const __m128i digits = _mm_loadu_si128((const __m128i *)hex_digits);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t blocks = len / 16;
+
+    for (size_t b = blocks; b-- > 0;) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(bytes + 16 * b));
+        __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+        __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(in, mask));
+
+        _mm_storeu_si128((__m128i *)(hex_out + 32 * b), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i *)(hex_out + 32 * b + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return blocks * 16;
+}
+
+__attribute__((target("avx2")))
+static size_t hex_encode_avx2(const uint8_t *bytes, size_t len, char *hex_out) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hex_digits));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t blocks = len / 32;
+
+    for (size_t b = blocks; b-- > 0;) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(bytes + 32 * b));
+        __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+        __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(in, mask));
+
+        // Unpack works within 128-bit halves: bytes 0-7/16-23 and 8-15/24-31
+        __m256i first = _mm256_unpacklo_epi8(high, low);
+        __m256i second = _mm256_unpackhi_epi8(high, low);
+
+        _mm256_storeu_si256((__m256i *)(hex_out + 64 * b),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *)(hex_out + 64 * b + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return blocks * 32;
+}
+
+// 32/64 characters to 16/32 bytes. Digits are c - '0' <= 9 and letters
+// (c | 0x20) - 'a' <= 5, both tested with unsigned min; characters that
+// are neither accumulate in `error`. Pairs of nibbles are then merged with
+// one multiply-add (high * 16 + low) and packed back to bytes.
+
+__attribute__((target("ssse3")))
+static inline __m128i hex_nibbles_ssse3(__m128i chars, __m128i *error) {
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_digit = _mm_cmpeq_epi8(digit, _mm_min_epu8(digit, _mm_set1_epi8(9)));
+    __m128i is_letter = _mm_cmpeq_epi8(letter, _mm_min_epu8(letter, _mm_set1_epi8(5)));
+
+    *error = _mm_or_si128(*error, _mm_andnot_si128(_mm_or_si128(is_digit, is_letter),
+                                                   _mm_set1_epi8(-1)));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static size_t hex_decode_ssse3(const char *hex, size_t len, uint8_t *bytes, unsigned *error_out) {
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i error = _mm_setzero_si128();
+    size_t blocks = len / 16;
+
+    for (size_t b = 0; b < blocks; b++) {
+        __m128i first = hex_nibbles_ssse3(_mm_loadu_si128((const __m128i *)(hex + 32 * b)), &error);
+        __m128i second = hex_nibbles_ssse3(_mm_loadu_si128((const __m128i *)(hex + 32 * b + 16)), &error);
+
+        __m128i packed = _mm_packus_epi16(_mm_maddubs_epi16(first, weights),
+                                          _mm_maddubs_epi16(second, weights));
+        _mm_storeu_si128((__m128i *)(bytes + 16 * b), packed);
+    }
+
+    *error_out = (unsigned)_mm_movemask_epi8(error);
+    return blocks * 16;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i hex_nibbles_avx2(__m256i chars, __m256i *error) {
+    __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)),
+                                     _mm256_set1_epi8('a'));
+    __m256i is_digit = _mm256_cmpeq_epi8(digit, _mm256_min_epu8(digit, _mm256_set1_epi8(9)));
+    __m256i is_letter = _mm256_cmpeq_epi8(letter, _mm256_min_epu8(letter, _mm256_set1_epi8(5)));
+
+    *error = _mm256_or_si256(*error, _mm256_andnot_si256(_mm256_or_si256(is_digit, is_letter),
+                                                         _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static size_t hex_decode_avx2(const char *hex, size_t len, uint8_t *bytes, unsigned *error_out) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    __m256i error = _mm256_setzero_si256();
+    size_t blocks = len / 32;
+
+    for (size_t b = 0; b < blocks; b++) {
+        __m256i first = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(hex + 64 * b)), &error);
+        __m256i second = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(hex + 64 * b + 32)), &error);
+
+        // Pack works within 128-bit halves; put the quadwords back in order
+        __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights),
+                                             _mm256_maddubs_epi16(second, weights));
+        _mm256_storeu_si256((__m256i *)(bytes + 32 * b), _mm256_permute4x64_epi64(packed, 0xd8));
+    }
+
+    *error_out = (unsigned)_mm256_movemask_epi8(error);
+    return blocks * 32;
+}
+
+#endif /* HEX_X86_SIMD */
+
+// Encode len bytes to 2 * len characters, no terminator. Safe in place.
+static void hex_encode(const uint8_t *bytes, size_t len, char *hex_out) {
+#ifdef HEX_X86_SIMD
+    int level = len >= 16 ? hex_simd_level() : 0;
+
+    // The tail goes first so the vector blocks before it stay unread
+    if (len >= 32 && level >= 2) {
+        size_t vector = len - len % 32;
+        hex_encode_scalar(bytes + vector, len - vector, hex_out + 2 * vector);
+        hex_encode_avx2(bytes, vector, hex_out);
+        return;
+    }
+    if (level >= 1) {
+        size_t vector = len - len % 16;
+        hex_encode_scalar(bytes + vector, len - vector, hex_out + 2 * vector);
+        hex_encode_ssse3(bytes, vector, hex_out);
+        return;
+    }
+#endif
+
+    hex_encode_scalar(bytes, len, hex_out);
+}
+
+int hex_decode(const char *hex, size_t hex_len, uint8_t *bytes) {
+    size_t len = hex_len / 2;
+    size_t done = 0;
+    unsigned error = 0;
+
+    if (hex_len % 2 != 0) {
+        return -1;
+    }
+
+#ifdef HEX_X86_SIMD
+    int level = len >= 16 ? hex_simd_level() : 0;
+
+    if (len >= 32 && level >= 2) {
+        done = hex_decode_avx2(hex, len, bytes, &error);
+    } else if (level >= 1) {
+        done = hex_decode_ssse3(hex, len, bytes, &error);
+    }
+#endif
+
+    error |= hex_decode_scalar(hex + 2 * done, len - done, bytes + done);
+    return error ? -1 : 0;
+}
+
+void bytes_to_hex(const uint8_t *bytes, size_t len, char *hex_out) {
+    hex_encode(bytes, len, hex_out);
+    hex_out[len * 2] = '\0';
+}
+
+int hex_to_bytes(const char *hex, uint8_t *bytes, size_t len) {
+    size_t hex_len = strlen(hex);
+
+    if (hex_len / 2 != len) {
+        return -1;
+    }
+
+    return hex_decode(hex, hex_len, bytes);
+}
+
+void bytes_to_hex_inplace(uint8_t *buffer, size_t len) {
+    hex_encode(buffer, len, (char *)buffer);
+}
+
+int hex_to_bytes_inplace(char *buffer, size_t hex_len) {
+    return hex_decode(buffer, hex_len, (uint8_t *)buffer);
+}
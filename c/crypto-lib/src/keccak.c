@@ -1,12 +1,26 @@
 /**
  * @file keccak.c
  * @brief Keccak-256 hash implementation for Ethereum addresses
+ *
+ * Keccak-f[1600] is written out one round at a time over 25 local lanes.
+ * The scalar permutation keeps six lanes complemented ("lane
+ * complementing"), which turns 20 of the 25 NOT operations chi needs per
+ * round into plain AND/OR. keccak256_batch() runs the same rounds across
+ * 4 (AVX2) or 8 (AVX-512) independent messages at once, one message per
+ * vector lane, picking the widest kernel the CPU supports at runtime.
  */
 
 #include "keccak.h"
 #include <string.h>
-#include <stdio.h>
-#include <ctype.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KECCAK_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define KECCAK_ROUNDS 24
+#define KECCAK256_RATE 136              /* 1088 bits */
+#define KECCAK256_RATE_LANES (KECCAK256_RATE / 8)
 
 // Keccak round constants
 static const uint64_t keccak_round_constants[24] = {
@@ -20,67 +34,464 @@ static const uint64_t keccak_round_constants[24] = {
     0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
 };
 
-// Rotation offsets
-static const int keccak_rotations[24] = {
-    1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
-    27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44
-};
+static inline uint64_t load64_le(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
 
-// Simplified Keccak-256 (for demonstration)
-void keccak256(const uint8_t *input, size_t input_len, uint8_t *output) {
-    // This is a simplified version for demonstration
-    // In production, use a proper crypto library like OpenSSL or libkeccak
+static inline void store64_le(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
 
-    uint8_t state[200] = {0};
+// Lanes are named A<row><column>: rows b g k m s (y = 0..4), columns
+// a e i o u (x = 0..4); lane (x, y) is state[x + 5 * y]. The rotation
+// offsets and the pi permutation are folded into the round below.
 
-    // Absorb phase
-    size_t rate = 136; // 1088 bits / 8
-    size_t offset = 0;
+#define KECCAK_DECLARE(T) \
+    T Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki; \
+    T Ako, Aku, Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu; \
+    T Bba, Bbe, Bbi, Bbo, Bbu, Bga, Bge, Bgi, Bgo, Bgu, Bka, Bke, Bki; \
+    T Bko, Bku, Bma, Bme, Bmi, Bmo, Bmu, Bsa, Bse, Bsi, Bso, Bsu; \
+    T Cx0, Cx1, Cx2, Cx3, Cx4, Dx0, Dx1, Dx2, Dx3, Dx4
 
-    while (offset < input_len) {
-        size_t block_size = (input_len - offset < rate) ?
-                           (input_len - offset) : rate;
+#define KECCAK_LOAD(s) \
+    do { \
+        Aba = (s)[0]; Abe = (s)[1]; Abi = (s)[2]; Abo = (s)[3]; Abu = (s)[4]; \
+        Aga = (s)[5]; Age = (s)[6]; Agi = (s)[7]; Ago = (s)[8]; Agu = (s)[9]; \
+        Aka = (s)[10]; Ake = (s)[11]; Aki = (s)[12]; Ako = (s)[13]; Aku = (s)[14]; \
+        Ama = (s)[15]; Ame = (s)[16]; Ami = (s)[17]; Amo = (s)[18]; Amu = (s)[19]; \
+        Asa = (s)[20]; Ase = (s)[21]; Asi = (s)[22]; Aso = (s)[23]; Asu = (s)[24]; \
+    } while (0)
 
-        for (size_t i = 0; i < block_size; i++) {
-            state[i] ^= input[offset + i];
-        }
+#define KECCAK_STORE(s) \
+    do { \
+        (s)[0] = Aba; (s)[1] = Abe; (s)[2] = Abi; (s)[3] = Abo; (s)[4] = Abu; \
+        (s)[5] = Aga; (s)[6] = Age; (s)[7] = Agi; (s)[8] = Ago; (s)[9] = Agu; \
+        (s)[10] = Aka; (s)[11] = Ake; (s)[12] = Aki; (s)[13] = Ako; (s)[14] = Aku; \
+        (s)[15] = Ama; (s)[16] = Ame; (s)[17] = Ami; (s)[18] = Amo; (s)[19] = Amu; \
+        (s)[20] = Asa; (s)[21] = Ase; (s)[22] = Asi; (s)[23] = Aso; (s)[24] = Asu; \
+    } while (0)
 
-        // Keccak-f[1600] permutation would go here
-        // (simplified for this example)
+#define ROL64(a, n) (((a) << (n)) | ((a) >> (64 - (n))))
+
+// One round on the lane-complemented state: lanes be, bi, go, ki, mi and
+// sa (1, 2, 8, 12, 17, 20) are stored inverted, which lets chi use one
+// NOT per row instead of five
+#define KECCAK_ROUND(rc) \
+    do { \
+        Cx0 = Aba ^ Aga ^ Aka ^ Ama ^ Asa; \
+        Cx1 = Abe ^ Age ^ Ake ^ Ame ^ Ase; \
+        Cx2 = Abi ^ Agi ^ Aki ^ Ami ^ Asi; \
+        Cx3 = Abo ^ Ago ^ Ako ^ Amo ^ Aso; \
+        Cx4 = Abu ^ Agu ^ Aku ^ Amu ^ Asu; \
+        Dx0 = Cx4 ^ ROL64(Cx1, 1); \
+        Dx1 = Cx0 ^ ROL64(Cx2, 1); \
+        Dx2 = Cx1 ^ ROL64(Cx3, 1); \
+        Dx3 = Cx2 ^ ROL64(Cx4, 1); \
+        Dx4 = Cx3 ^ ROL64(Cx0, 1); \
+        Bba = (Aba ^ Dx0); \
+        Bbe = ROL64((Age ^ Dx1), 44); \
+        Bbi = ROL64((Aki ^ Dx2), 43); \
+        Bbo = ROL64((Amo ^ Dx3), 21); \
+        Bbu = ROL64((Asu ^ Dx4), 14); \
+        Bga = ROL64((Abo ^ Dx3), 28); \
+        Bge = ROL64((Agu ^ Dx4), 20); \
+        Bgi = ROL64((Aka ^ Dx0), 3); \
+        Bgo = ROL64((Ame ^ Dx1), 45); \
+        Bgu = ROL64((Asi ^ Dx2), 61); \
+        Bka = ROL64((Abe ^ Dx1), 1); \
+        Bke = ROL64((Agi ^ Dx2), 6); \
+        Bki = ROL64((Ako ^ Dx3), 25); \
+        Bko = ROL64((Amu ^ Dx4), 8); \
+        Bku = ROL64((Asa ^ Dx0), 18); \
+        Bma = ROL64((Abu ^ Dx4), 27); \
+        Bme = ROL64((Aga ^ Dx0), 36); \
+        Bmi = ROL64((Ake ^ Dx1), 10); \
+        Bmo = ROL64((Ami ^ Dx2), 15); \
+        Bmu = ROL64((Aso ^ Dx3), 56); \
+        Bsa = ROL64((Abi ^ Dx2), 62); \
+        Bse = ROL64((Ago ^ Dx3), 55); \
+        Bsi = ROL64((Aku ^ Dx4), 39); \
+        Bso = ROL64((Ama ^ Dx0), 41); \
+        Bsu = ROL64((Ase ^ Dx1), 2); \
+        Aba = Bba ^ (Bbe | Bbi); \
+        Abe = Bbe ^ (~Bbi | Bbo); \
+        Abi = Bbi ^ (Bbo & Bbu); \
+        Abo = Bbo ^ (Bbu | Bba); \
+        Abu = Bbu ^ (Bba & Bbe); \
+        Aga = Bga ^ (Bge | Bgi); \
+        Age = Bge ^ (Bgi & Bgo); \
+        Agi = Bgi ^ (Bgo | ~Bgu); \
+        Ago = Bgo ^ (Bgu | Bga); \
+        Agu = Bgu ^ (Bga & Bge); \
+        Aka = Bka ^ (Bke | Bki); \
+        Ake = Bke ^ (Bki & Bko); \
+        Aki = Bki ^ (~Bko & Bku); \
+        Ako = ~Bko ^ (Bku | Bka); \
+        Aku = Bku ^ (Bka & Bke); \
+        Ama = Bma ^ (Bme & Bmi); \
+        Ame = Bme ^ (Bmi | Bmo); \
+        Ami = Bmi ^ (~Bmo | Bmu); \
+        Amo = ~Bmo ^ (Bmu & Bma); \
+        Amu = Bmu ^ (Bma | Bme); \
+        Asa = Bsa ^ (~Bse & Bsi); \
+        Ase = ~Bse ^ (Bsi | Bso); \
+        Asi = Bsi ^ (Bso & Bsu); \
+        Aso = Bso ^ (Bsu | Bsa); \
+        Asu = Bsu ^ (Bsa & Bse); \
+        Aba ^= (rc); \
+    } while (0)
+
+// Lanes kept inverted by the scalar permutation
+static const int keccak_complemented_lanes[6] = {1, 2, 8, 12, 17, 20};
+
+static void keccak_complement(uint64_t state[25]) {
+    for (int i = 0; i < 6; i++) {
+        state[keccak_complemented_lanes[i]] = ~state[keccak_complemented_lanes[i]];
+    }
+}
+
+// Keccak-f[1600] on a state already in complemented form. Absorbing by
+// XOR works the same in either form, so a sponge only converts at the
+// start and when squeezing.
+static void keccak_f1600_complemented(uint64_t state[25]) {
+    KECCAK_DECLARE(uint64_t);
+
+    KECCAK_LOAD(state);
+    for (int round = 0; round < KECCAK_ROUNDS; round++) {
+        KECCAK_ROUND(keccak_round_constants[round]);
+    }
+    KECCAK_STORE(state);
+}
 
-        offset += block_size;
+void keccak_f1600(uint64_t state[25]) {
+    keccak_complement(state);
+    keccak_f1600_complemented(state);
+    keccak_complement(state);
+}
+
+// Final block of a message: the tail bytes with Keccak's 0x01 ... 0x80
+// padding (not SHA-3's 0x06)
+static void keccak256_pad_block(const uint8_t *tail, size_t tail_len,
+                                uint8_t block[KECCAK256_RATE]) {
+    memset(block, 0, KECCAK256_RATE);
+    if (tail_len > 0) {
+        memcpy(block, tail, tail_len);
+    }
+    block[tail_len] ^= 0x01;
+    block[KECCAK256_RATE - 1] ^= 0x80;
+}
+
+void keccak256_init(keccak256_ctx *ctx) {
+    memset(ctx->state, 0, sizeof(ctx->state));
+    keccak_complement(ctx->state);
+    ctx->position = 0;
+}
+
+// XOR bytes into the current block at ctx->position, which must not run
+// past the end of the block
+static void keccak256_absorb_bytes(keccak256_ctx *ctx, const uint8_t *input, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        size_t at = ctx->position + i;
+        ctx->state[at / 8] ^= (uint64_t)input[i] << (8 * (at % 8));
+    }
+    ctx->position += len;
+}
+
+void keccak256_update(keccak256_ctx *ctx, const uint8_t *input, size_t input_len) {
+    // Top up a partly filled block first
+    if (ctx->position > 0) {
+        size_t room = KECCAK256_RATE - ctx->position;
+        size_t take = input_len < room ? input_len : room;
+
+        keccak256_absorb_bytes(ctx, input, take);
+        input += take;
+        input_len -= take;
+
+        if (ctx->position < KECCAK256_RATE) {
+            return;
+        }
+        keccak_f1600_complemented(ctx->state);
+        ctx->position = 0;
+    }
+
+    // Absorb phase: whole blocks straight from the input, a lane at a time
+    while (input_len >= KECCAK256_RATE) {
+        for (int i = 0; i < KECCAK256_RATE_LANES; i++) {
+            ctx->state[i] ^= load64_le(input + 8 * i);
+        }
+        keccak_f1600_complemented(ctx->state);
+        input += KECCAK256_RATE;
+        input_len -= KECCAK256_RATE;
     }
 
+    keccak256_absorb_bytes(ctx, input, input_len);
+}
+
+void keccak256_final(keccak256_ctx *ctx, uint8_t *output) {
     // Padding
-    state[input_len % rate] ^= 0x01;
-    state[rate - 1] ^= 0x80;
+    ctx->state[ctx->position / 8] ^= (uint64_t)0x01 << (8 * (ctx->position % 8));
+    ctx->state[KECCAK256_RATE_LANES - 1] ^= (uint64_t)0x80 << 56;
+    keccak_f1600_complemented(ctx->state);
 
     // Squeeze phase
-    memcpy(output, state, KECCAK256_HASH_SIZE);
+    keccak_complement(ctx->state);
+    for (int i = 0; i < KECCAK256_HASH_SIZE / 8; i++) {
+        store64_le(output + 8 * i, ctx->state[i]);
+    }
 }
 
-void bytes_to_hex(const uint8_t *bytes, size_t len, char *hex_out) {
-    for (size_t i = 0; i < len; i++) {
-        sprintf(hex_out + (i * 2), "%02x", bytes[i]);
+void keccak256(const uint8_t *input, size_t input_len, uint8_t *output) {
+    keccak256_ctx ctx;
+
+    keccak256_init(&ctx);
+    keccak256_update(&ctx, input, input_len);
+    keccak256_final(&ctx, output);
+}
+
+// Blocks a message occupies once padded (always at least one)
+static size_t keccak256_block_count(size_t input_len) {
+    return input_len / KECCAK256_RATE + 1;
+}
+
+// Shared by the multi-buffer kernels: pointer to block `index` of a
+// message, padding the final block into `scratch` and returning zeros
+// past the end, so messages of different lengths can share a batch
+static const uint8_t *keccak256_batch_block(const uint8_t *input, size_t input_len,
+                                            size_t index, uint8_t scratch[KECCAK256_RATE]) {
+    static const uint8_t zeros[KECCAK256_RATE] = {0};
+    size_t blocks = keccak256_block_count(input_len);
+
+    if (index + 1 < blocks) {
+        return input + index * KECCAK256_RATE;
     }
-    hex_out[len * 2] = '\0';
+    if (index + 1 == blocks) {
+        keccak256_pad_block(input + index * KECCAK256_RATE,
+                            input_len - index * KECCAK256_RATE, scratch);
+        return scratch;
+    }
+    return zeros;
+}
+
+#ifdef KECCAK_X86_SIMD
+
+// Plain round over vector lanes, for the multi-buffer kernels. AVX2 and
+// AVX-512 both have and-not, so complementing buys nothing here.
+#define KECCAK_ROUND_V(rc) \
+    do { \
+        Cx0 = XOR5(Aba, Aga, Aka, Ama, Asa); \
+        Cx1 = XOR5(Abe, Age, Ake, Ame, Ase); \
+        Cx2 = XOR5(Abi, Agi, Aki, Ami, Asi); \
+        Cx3 = XOR5(Abo, Ago, Ako, Amo, Aso); \
+        Cx4 = XOR5(Abu, Agu, Aku, Amu, Asu); \
+        Dx0 = XOR(Cx4, ROL(Cx1, 1)); \
+        Dx1 = XOR(Cx0, ROL(Cx2, 1)); \
+        Dx2 = XOR(Cx1, ROL(Cx3, 1)); \
+        Dx3 = XOR(Cx2, ROL(Cx4, 1)); \
+        Dx4 = XOR(Cx3, ROL(Cx0, 1)); \
+        Bba = XOR(Aba, Dx0); \
+        Bbe = ROL(XOR(Age, Dx1), 44); \
+        Bbi = ROL(XOR(Aki, Dx2), 43); \
+        Bbo = ROL(XOR(Amo, Dx3), 21); \
+        Bbu = ROL(XOR(Asu, Dx4), 14); \
+        Bga = ROL(XOR(Abo, Dx3), 28); \
+        Bge = ROL(XOR(Agu, Dx4), 20); \
+        Bgi = ROL(XOR(Aka, Dx0), 3); \
+        Bgo = ROL(XOR(Ame, Dx1), 45); \
+        Bgu = ROL(XOR(Asi, Dx2), 61); \
+        Bka = ROL(XOR(Abe, Dx1), 1); \
+        Bke = ROL(XOR(Agi, Dx2), 6); \
+        Bki = ROL(XOR(Ako, Dx3), 25); \
+        Bko = ROL(XOR(Amu, Dx4), 8); \
+        Bku = ROL(XOR(Asa, Dx0), 18); \
+        Bma = ROL(XOR(Abu, Dx4), 27); \
+        Bme = ROL(XOR(Aga, Dx0), 36); \
+        Bmi = ROL(XOR(Ake, Dx1), 10); \
+        Bmo = ROL(XOR(Ami, Dx2), 15); \
+        Bmu = ROL(XOR(Aso, Dx3), 56); \
+        Bsa = ROL(XOR(Abi, Dx2), 62); \
+        Bse = ROL(XOR(Ago, Dx3), 55); \
+        Bsi = ROL(XOR(Aku, Dx4), 39); \
+        Bso = ROL(XOR(Ama, Dx0), 41); \
+        Bsu = ROL(XOR(Ase, Dx1), 2); \
+        Aba = CHI(Bba, Bbe, Bbi); \
+        Abe = CHI(Bbe, Bbi, Bbo); \
+        Abi = CHI(Bbi, Bbo, Bbu); \
+        Abo = CHI(Bbo, Bbu, Bba); \
+        Abu = CHI(Bbu, Bba, Bbe); \
+        Aga = CHI(Bga, Bge, Bgi); \
+        Age = CHI(Bge, Bgi, Bgo); \
+        Agi = CHI(Bgi, Bgo, Bgu); \
+        Ago = CHI(Bgo, Bgu, Bga); \
+        Agu = CHI(Bgu, Bga, Bge); \
+        Aka = CHI(Bka, Bke, Bki); \
+        Ake = CHI(Bke, Bki, Bko); \
+        Aki = CHI(Bki, Bko, Bku); \
+        Ako = CHI(Bko, Bku, Bka); \
+        Aku = CHI(Bku, Bka, Bke); \
+        Ama = CHI(Bma, Bme, Bmi); \
+        Ame = CHI(Bme, Bmi, Bmo); \
+        Ami = CHI(Bmi, Bmo, Bmu); \
+        Amo = CHI(Bmo, Bmu, Bma); \
+        Amu = CHI(Bmu, Bma, Bme); \
+        Asa = CHI(Bsa, Bse, Bsi); \
+        Ase = CHI(Bse, Bsi, Bso); \
+        Asi = CHI(Bsi, Bso, Bsu); \
+        Aso = CHI(Bso, Bsu, Bsa); \
+        Asu = CHI(Bsu, Bsa, Bse); \
+        Aba = XOR(Aba, (rc)); \
+    } while (0)
+
+/*
+ * Hash `W` messages in parallel. `T` is the vector type, `LOAD_LANES`
+ * builds a vector from the W message pointers at byte offset `o`, and
+ * `STORE` writes a vector to W uint64_t. A message's digest is taken right
+ * after its own last block; the lane keeps permuting zeros until the
+ * longest message of the group is done.
+ */
+#define KECCAK256_MULTI(W, T, ZERO, LOAD_LANES, STORE) \
+    do { \
+        KECCAK_DECLARE(T); \
+        T state[25]; \
+        uint8_t scratch[W][KECCAK256_RATE]; \
+        const uint8_t *block[W]; \
+        uint64_t lanes[W]; \
+        size_t max_blocks = 0; \
+        for (int m = 0; m < (W); m++) { \
+            size_t blocks = keccak256_block_count(input_lens[m]); \
+            if (blocks > max_blocks) max_blocks = blocks; \
+        } \
+        for (int i = 0; i < 25; i++) state[i] = (ZERO); \
+        for (size_t b = 0; b < max_blocks; b++) { \
+            for (int m = 0; m < (W); m++) { \
+                block[m] = keccak256_batch_block(inputs[m], input_lens[m], b, scratch[m]); \
+            } \
+            for (int i = 0; i < KECCAK256_RATE_LANES; i++) { \
+                state[i] = XOR(state[i], LOAD_LANES(block, 8 * i)); \
+            } \
+            KECCAK_LOAD(state); \
+            for (int round = 0; round < KECCAK_ROUNDS; round++) { \
+                KECCAK_ROUND_V(RC(keccak_round_constants[round])); \
+            } \
+            KECCAK_STORE(state); \
+            for (int i = 0; i < KECCAK256_HASH_SIZE / 8; i++) { \
+                STORE(lanes, state[i]); \
+                for (int m = 0; m < (W); m++) { \
+                    if (keccak256_block_count(input_lens[m]) == b + 1) { \
+                        store64_le(outputs + m * KECCAK256_HASH_SIZE + 8 * i, lanes[m]); \
+                    } \
+                } \
+            } \
+        } \
+    } while (0)
+
+#define XOR(a, b) _mm256_xor_si256((a), (b))
+#define XOR5(a, b, c, d, e) XOR(XOR(XOR(a, b), XOR(c, d)), e)
+#define ROL(a, n) _mm256_or_si256(_mm256_slli_epi64((a), (n)), _mm256_srli_epi64((a), 64 - (n)))
+#define CHI(a, b, c) XOR((a), _mm256_andnot_si256((b), (c)))
+#define RC(c) _mm256_set1_epi64x((long long)(c))
+#define LOAD4(p, o) _mm256_set_epi64x((long long)load64_le((p)[3] + (o)), \
+                                      (long long)load64_le((p)[2] + (o)), \
+                                      (long long)load64_le((p)[1] + (o)), \
+                                      (long long)load64_le((p)[0] + (o)))
+#define STORE4(out, v) _mm256_storeu_si256((__m256i *)(out), (v))
+
+__attribute__((target("avx2")))
+static void keccak256_x4_avx2(const uint8_t *const *inputs, const size_t *input_lens,
+                              uint8_t *outputs) {
+    KECCAK256_MULTI(4, __m256i, _mm256_setzero_si256(), LOAD4, STORE4);
 }
 
-int hex_to_bytes(const char *hex, uint8_t *bytes, size_t len) {
-    size_t hex_len = strlen(hex);
+#undef XOR
+#undef XOR5
+#undef ROL
+#undef CHI
+#undef RC
+
+#define XOR(a, b) _mm512_xor_si512((a), (b))
+#define XOR5(a, b, c, d, e) \
+    _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64((a), (b), (c), 0x96), (d), (e), 0x96)
+#define ROL(a, n) _mm512_rol_epi64((a), (n))
+#define CHI(a, b, c) _mm512_ternarylogic_epi64((a), (b), (c), 0xd2)  /* a ^ (~b & c) */
+#define RC(c) _mm512_set1_epi64((long long)(c))
+#define LOAD8(p, o) _mm512_set_epi64((long long)load64_le((p)[7] + (o)), \
+                                     (long long)load64_le((p)[6] + (o)), \
+                                     (long long)load64_le((p)[5] + (o)), \
+                                     (long long)load64_le((p)[4] + (o)), \
+                                     (long long)load64_le((p)[3] + (o)), \
+                                     (long long)load64_le((p)[2] + (o)), \
+                                     (long long)load64_le((p)[1] + (o)), \
+                                     (long long)load64_le((p)[0] + (o)))
+#define STORE8(out, v) _mm512_storeu_si512((void *)(out), (v))
+
+__attribute__((target("avx512f")))
+static void keccak256_x8_avx512(const uint8_t *const *inputs, const size_t *input_lens,
+                                uint8_t *outputs) {
+    KECCAK256_MULTI(8, __m512i, _mm512_setzero_si512(), LOAD8, STORE8);
+}
 
-    if (hex_len % 2 != 0) {
-        return -1;
+#undef XOR
+#undef XOR5
+#undef ROL
+#undef CHI
+#undef RC
+
+#endif /* KECCAK_X86_SIMD */
+
+#ifdef KECCAK_X86_SIMD
+static int keccak256_detect_width(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return 8;
     }
+    if (__builtin_cpu_supports("avx2")) {
+        return 4;
+    }
+    return 1;
+}
+#endif
 
-    if (hex_len / 2 != len) {
-        return -1;
+int keccak256_batch_width(void) {
+#ifdef KECCAK_X86_SIMD
+    // Detected on first use; callers racing on it all store the same value
+    static int width;
+    int cached = __atomic_load_n(&width, __ATOMIC_RELAXED);
+    if (cached == 0) {
+        cached = keccak256_detect_width();
+        __atomic_store_n(&width, cached, __ATOMIC_RELAXED);
     }
+    return cached;
+#else
+    return 1;
+#endif
+}
 
-    for (size_t i = 0; i < len; i++) {
-        char byte_str[3] = {hex[i * 2], hex[i * 2 + 1], '\0'};
-        bytes[i] = (uint8_t)strtol(byte_str, NULL, 16);
+void keccak256_batch(const uint8_t *const *inputs, const size_t *input_lens,
+                     size_t count, uint8_t *outputs) {
+    size_t i = 0;
+
+#ifdef KECCAK_X86_SIMD
+    int width = keccak256_batch_width();
+
+    if (width >= 8) {
+        for (; i + 8 <= count; i += 8) {
+            keccak256_x8_avx512(inputs + i, input_lens + i, outputs + i * KECCAK256_HASH_SIZE);
+        }
+    }
+    if (width >= 4) {
+        for (; i + 4 <= count; i += 4) {
+            keccak256_x4_avx2(inputs + i, input_lens + i, outputs + i * KECCAK256_HASH_SIZE);
+        }
     }
+#endif
 
-    return 0;
+    // Remainder, or everything without SIMD support
+    for (; i < count; i++) {
+        keccak256(inputs[i], input_lens[i], outputs + i * KECCAK256_HASH_SIZE);
+    }
 }
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace DEX {
+
+// Fixed-size log-linear histogram of latencies in nanoseconds.
+//
+// Each power of two is split into 32 linear buckets, so any recorded value
+// is reported within ~3% of its true value, from 1ns up to the full 64 bit
+// range. Recording is a couple of shifts and an increment with no
+// allocation, cheap enough to sit inside a timed loop.
+class LatencyHistogram {
+public:
+    void record(uint64_t nanos) {
+        ++buckets_[bucketOf(nanos)];
+        ++count_;
+        sum_ += nanos;
+        min_ = std::min(min_, nanos);
+        max_ = std::max(max_, nanos);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    // Value at or below which `fraction` (0..1) of the samples fall
+    uint64_t percentile(double fraction) const {
+        if (count_ == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) {
+                return std::min(std::max(valueOf(i), min_), max_);
+            }
+        }
+        return max_;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+private:
+    static constexpr unsigned kSubBits = 5;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    std::array<uint64_t, kBuckets> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<size_t>(value);
+
+        unsigned shift = 63 - static_cast<unsigned>(__builtin_clzll(value)) - kSubBits;
+        return (shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+    }
+
+    // Midpoint of a bucket's range
+    static uint64_t valueOf(size_t bucket) {
+        if (bucket < kSubBuckets) return bucket;
+
+        unsigned shift = static_cast<unsigned>(bucket / kSubBuckets) - 1;
+        uint64_t low = (kSubBuckets + bucket % kSubBuckets) << shift;
+        return low + ((1ull << shift) >> 1);
+    }
+};
+
+} // namespace DEX
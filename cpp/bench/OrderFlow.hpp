@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Order.hpp"
+#include "PairSpec.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace DEX {
+
+// Shape of a synthetic order stream around a fixed mid price
+struct FlowOptions {
+    Price midPrice = 100000;        // Ticks
+    uint32_t depth = 100;           // Passive orders land within this many ticks of mid
+    double cancelRatio = 0.3;       // Share of events that cancel a resting order
+    double aggressiveRatio = 0.1;   // Share of submits that cross the spread
+    uint32_t sweepTicks = 5;        // How far past mid an aggressive order reaches
+    Quantity maxLots = 10;          // Order sizes are uniform in [1, maxLots]
+    uint64_t seed = 1;
+};
+
+struct FlowEvent {
+    enum class Kind : uint8_t { SUBMIT, CANCEL };
+
+    Kind kind = Kind::SUBMIT;
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;        // Ticks
+    Quantity quantity = 0;  // Lots
+    uint64_t orderId = 0;   // CANCEL only
+};
+
+// Deterministic random order flow. Passive limits rest on a book `depth`
+// ticks deep on each side of mid, aggressive limits sweep a few ticks into
+// the other side, and cancels target orders the caller reported as resting
+// through onResting(). The same options and seed always produce the same
+// stream for the same engine responses.
+class OrderFlow {
+public:
+    explicit OrderFlow(const FlowOptions& options) : options_(options), random_(options.seed) {}
+
+    FlowEvent next() {
+        FlowEvent event;
+
+        if (!resting_.empty() && unit() < options_.cancelRatio) {
+            // Swap-remove a random resting order; it may have filled since,
+            // in which case the cancel simply finds nothing
+            size_t index = random_() % resting_.size();
+            event.kind = FlowEvent::Kind::CANCEL;
+            event.orderId = resting_[index];
+            resting_[index] = resting_.back();
+            resting_.pop_back();
+            return event;
+        }
+
+        event.side = (random_() & 1) ? OrderSide::BUY : OrderSide::SELL;
+        event.quantity = 1 + static_cast<Quantity>(random_() % static_cast<uint64_t>(options_.maxLots));
+
+        bool buy = event.side == OrderSide::BUY;
+        Price offset;
+        if (unit() < options_.aggressiveRatio) {
+            offset = -static_cast<Price>(random_() % (options_.sweepTicks + 1));
+        } else {
+            offset = 1 + static_cast<Price>(random_() % options_.depth);
+        }
+        event.price = buy ? options_.midPrice - offset : options_.midPrice + offset;
+        return event;
+    }
+
+    // Report an order from a SUBMIT that is now resting, so it can be cancelled later
+    void onResting(uint64_t orderId) { resting_.push_back(orderId); }
+
+    // Submits that prefill `levels` ticks on each side of mid with
+    // `ordersPerLevel` orders each, without crossing
+    std::vector<FlowEvent> seedBook(uint32_t levels, uint32_t ordersPerLevel) {
+        std::vector<FlowEvent> events;
+        events.reserve(static_cast<size_t>(levels) * ordersPerLevel * 2);
+
+        for (uint32_t level = 1; level <= levels; ++level) {
+            for (uint32_t i = 0; i < ordersPerLevel; ++i) {
+                for (OrderSide side : {OrderSide::BUY, OrderSide::SELL}) {
+                    FlowEvent event;
+                    event.side = side;
+                    event.price = side == OrderSide::BUY ? options_.midPrice - level
+                                                         : options_.midPrice + level;
+                    event.quantity = 1 + static_cast<Quantity>(random_() % static_cast<uint64_t>(options_.maxLots));
+                    events.push_back(event);
+                }
+            }
+        }
+        return events;
+    }
+
+    size_t restingCount() const { return resting_.size(); }
+
+private:
+    FlowOptions options_;
+    std::mt19937_64 random_;
+    std::vector<uint64_t> resting_;
+
+    double unit() { return static_cast<double>(random_() >> 11) * 0x1.0p-53; }
+};
+
+} // namespace DEX
@@ -0,0 +1,534 @@
+#include "LatencyHistogram.hpp"
+#include "OrderFlow.hpp"
+#include "../include/MatchingEngine.hpp"
+#include "../include/ShardedEngine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DEX;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    size_t orders = 1000000;       // Operations per single-threaded benchmark
+    uint32_t depth = 100;          // Ticks each side of mid the passive flow uses
+    uint32_t deepLevels = 5000;    // Levels per side for the depth benchmark
+    double cancelRatio = 0.3;
+    double aggressiveRatio = 0.1;
+    size_t threads = 4;
+    size_t pairs = 8;
+    uint64_t seed = 1;
+    BookMemory bookMemory;         // Where every benchmark's books live
+    std::vector<std::string> only; // Benchmarks to run, all if empty
+};
+
+constexpr size_t kUsers = 64;
+
+double seconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+uint64_t nanos(Clock::time_point start, Clock::time_point end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+void printHeader() {
+    std::printf("%-22s %12s %12s %9s %8s %8s %8s %9s\n",
+                "benchmark", "ops", "ops/s", "ns/op", "p50", "p99", "p99.9", "max");
+}
+
+void printRow(const char* name, uint64_t ops, double elapsed, const LatencyHistogram* latency = nullptr) {
+    double rate = elapsed > 0 ? static_cast<double>(ops) / elapsed : 0.0;
+    double perOp = ops ? elapsed * 1e9 / static_cast<double>(ops) : 0.0;
+
+    std::printf("%-22s %12llu %12.0f %9.1f", name, static_cast<unsigned long long>(ops), rate, perOp);
+    if (latency && latency->count() > 0) {
+        std::printf(" %8llu %8llu %8llu %9llu",
+                    static_cast<unsigned long long>(latency->percentile(0.50)),
+                    static_cast<unsigned long long>(latency->percentile(0.99)),
+                    static_cast<unsigned long long>(latency->percentile(0.999)),
+                    static_cast<unsigned long long>(latency->max()));
+    }
+    std::printf("\n");
+}
+
+// Where the time went, for DEX_ENABLE_STATS builds
+void printStats(const MatchingEngine& engine) {
+    if (!EngineStats::kEnabled) return;
+
+    EngineStats stats = engine.getStats();
+    const BookStats& books = stats.books;
+    auto perCall = [](const StageStats& stage) {
+        return stage.count ? static_cast<double>(stage.cycles) / static_cast<double>(stage.count) : 0.0;
+    };
+    auto perOrder = [&](uint64_t value) {
+        return books.orders ? static_cast<double>(value) / static_cast<double>(books.orders) : 0.0;
+    };
+
+    std::printf("  stages (cycles/call): lookup %.0f, prepare %.0f, match %.0f, rest %.0f, publish %.0f\n",
+                perCall(stats.lookup), perCall(stats.prepare), perCall(books.match),
+                perCall(books.rest), perCall(books.publish));
+    std::printf("  per order: %.2f levels touched, %.2f trades, %.3f allocations\n",
+                perOrder(books.levelsTouched), perOrder(books.trades), perOrder(books.allocations));
+    std::printf("  engine lock: %llu acquired, %llu contended, %llu wait cycles; "
+                "book locks: %llu acquired, %llu contended, %llu wait cycles\n",
+                static_cast<unsigned long long>(stats.engineLock.acquisitions),
+                static_cast<unsigned long long>(stats.engineLock.contended),
+                static_cast<unsigned long long>(stats.engineLock.waitCycles),
+                static_cast<unsigned long long>(books.lock.acquisitions),
+                static_cast<unsigned long long>(books.lock.contended),
+                static_cast<unsigned long long>(books.lock.waitCycles));
+}
+
+FlowOptions flowOptions(const Config& config, uint64_t stream = 0) {
+    FlowOptions options;
+    options.depth = config.depth;
+    options.cancelRatio = config.cancelRatio;
+    options.aggressiveRatio = config.aggressiveRatio;
+    options.seed = config.seed + stream;
+    return options;
+}
+
+// Engine with `pairs` pairs and kUsers users, all resolved up front
+struct Fixture {
+    MatchingEngine engine;
+    std::vector<PairId> pairs;
+    std::vector<UserId> users;
+    PairSpec spec;
+
+    explicit Fixture(const Config& config, size_t pairCount = 1) {
+        engine.setBookMemory(config.bookMemory);
+        for (size_t i = 0; i < pairCount; ++i) {
+            pairs.push_back(engine.addTradingPair("PAIR" + std::to_string(i) + "/USD", spec));
+        }
+        for (size_t i = 0; i < kUsers; ++i) {
+            users.push_back(engine.internUser("user" + std::to_string(i)));
+        }
+    }
+};
+
+// Apply one generated event through the public ID-based API
+struct Driver {
+    Fixture& fixture;
+    PairId pair;
+    OrderFlow& flow;
+    uint64_t trades = 0;
+    uint64_t events = 0;
+
+    bool apply(const FlowEvent& event) {
+        auto countTrade = [this](const Trade&) { ++trades; };
+        uint64_t index = events++;
+
+        if (event.kind == FlowEvent::Kind::CANCEL) {
+            return fixture.engine.cancelOrder(event.orderId, pair);
+        }
+
+        OrderResult result = fixture.engine.submitOrder(
+            pair, fixture.users[index % kUsers], event.side, OrderType::LIMIT,
+            fixture.spec.toPrice(event.price), fixture.spec.toQuantity(event.quantity), countTrade);
+        if (result.status == OrderStatus::PENDING || result.status == OrderStatus::PARTIAL) {
+            flow.onResting(result.orderId);
+        }
+        return true;
+    }
+
+    void seed(uint32_t levels, uint32_t ordersPerLevel) {
+        for (const FlowEvent& event : flow.seedBook(levels, ordersPerLevel)) {
+            apply(event);
+        }
+    }
+};
+
+// Passive limit orders that never cross: insertion into levels and the index
+void benchAdd(const Config& config) {
+    Fixture fixture(config);
+    FlowOptions options = flowOptions(config);
+    options.cancelRatio = 0;
+    options.aggressiveRatio = 0;
+    OrderFlow flow(options);
+    Driver driver{fixture, fixture.pairs[0], flow};
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < config.orders; ++i) {
+        driver.apply(flow.next());
+    }
+    printRow("add", config.orders, seconds(start, Clock::now()));
+}
+
+// Cancel every order of a book built by benchAdd, in random order
+void benchCancel(const Config& config) {
+    Fixture fixture(config);
+    FlowOptions options = flowOptions(config);
+    options.cancelRatio = 0;
+    options.aggressiveRatio = 0;
+    OrderFlow flow(options);
+    Driver driver{fixture, fixture.pairs[0], flow};
+
+    std::vector<uint64_t> ids;
+    ids.reserve(config.orders);
+    for (size_t i = 0; i < config.orders; ++i) {
+        driver.apply(flow.next());
+        ids.push_back(fixture.engine.getTotalOrders());
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937_64(config.seed));
+
+    size_t cancelled = 0;
+    auto start = Clock::now();
+    for (uint64_t id : ids) {
+        cancelled += fixture.engine.cancelOrder(id, fixture.pairs[0]);
+    }
+    double elapsed = seconds(start, Clock::now());
+
+    if (cancelled != ids.size()) {
+        std::fprintf(stderr, "cancel: only %zu of %zu orders cancelled\n", cancelled, ids.size());
+    }
+    printRow("cancel", ids.size(), elapsed);
+}
+
+// Half the orders cross into a seeded book, so most events match
+void benchMatch(const Config& config) {
+    Fixture fixture(config);
+    FlowOptions options = flowOptions(config);
+    options.cancelRatio = 0;
+    options.aggressiveRatio = 0.5;
+    OrderFlow flow(options);
+    Driver driver{fixture, fixture.pairs[0], flow};
+    driver.seed(config.depth, 4);
+    driver.trades = 0;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < config.orders; ++i) {
+        driver.apply(flow.next());
+    }
+    double elapsed = seconds(start, Clock::now());
+
+    printRow("match", config.orders, elapsed);
+    printRow("match (trades)", driver.trades, elapsed);
+}
+
+// Realistic mix of passive adds, crossing orders and cancels; untimed per
+// op for throughput, then timed per op for the latency distribution
+void benchMixed(const Config& config) {
+    {
+        Fixture fixture(config);
+        OrderFlow flow(flowOptions(config));
+        Driver driver{fixture, fixture.pairs[0], flow};
+        driver.seed(config.depth, 4);
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < config.orders; ++i) {
+            driver.apply(flow.next());
+        }
+        printRow("mixed", config.orders, seconds(start, Clock::now()));
+        printStats(fixture.engine);
+    }
+
+    Fixture fixture(config);
+    OrderFlow flow(flowOptions(config));
+    Driver driver{fixture, fixture.pairs[0], flow};
+    driver.seed(config.depth, 4);
+
+    LatencyHistogram submits, cancels;
+    for (size_t i = 0; i < config.orders; ++i) {
+        FlowEvent event = flow.next();
+
+        auto start = Clock::now();
+        driver.apply(event);
+        auto end = Clock::now();
+
+        (event.kind == FlowEvent::Kind::CANCEL ? cancels : submits).record(nanos(start, end));
+    }
+
+    // Throughput columns here are from the summed per-op times
+    auto busy = [](const LatencyHistogram& h) { return h.mean() * static_cast<double>(h.count()) * 1e-9; };
+    printRow("latency submitOrder", submits.count(), busy(submits), &submits);
+    printRow("latency cancelOrder", cancels.count(), busy(cancels), &cancels);
+}
+
+// Depth and snapshot queries against a book deeper than the price ladder window
+void benchDepth(const Config& config) {
+    Fixture fixture(config);
+    OrderFlow flow(flowOptions(config));
+    Driver driver{fixture, fixture.pairs[0], flow};
+    driver.seed(config.deepLevels, 2);
+
+    OrderBook& book = *fixture.engine.getOrderBook(fixture.pairs[0]);
+    size_t queries = std::max<size_t>(config.orders / 100, 1);
+    std::vector<DepthLevel> levels(config.deepLevels);
+    size_t sink = 0;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < queries * 10; ++i) {
+        sink += book.getSnapshot().bidLevels;
+    }
+    printRow("depth snapshot", queries * 10, seconds(start, Clock::now()));
+
+    start = Clock::now();
+    for (size_t i = 0; i < queries * 10; ++i) {
+        sink += book.getBidDepth(levels.data(), 50);
+    }
+    printRow("depth 50 levels", queries * 10, seconds(start, Clock::now()));
+
+    size_t full = std::max<size_t>(queries / 10, 1);
+    start = Clock::now();
+    for (size_t i = 0; i < full; ++i) {
+        sink += book.getAskDepth(levels.data(), levels.size());
+    }
+    printRow("depth full book", full, seconds(start, Clock::now()));
+
+    start = Clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        sink += fixture.engine.getMarketData(fixture.pairs[0]).bidDepth.size();
+    }
+    printRow("getMarketData", queries, seconds(start, Clock::now()));
+
+    if (sink == 0) {
+        std::fprintf(stderr, "depth: empty book\n");
+    }
+}
+
+// Threads submit mixed flow concurrently, each to its own subset of pairs
+void benchThreaded(const Config& config) {
+    size_t threads = std::max<size_t>(config.threads, 1);
+    size_t pairs = std::max(config.pairs, threads);
+    size_t perThread = config.orders / threads;
+
+    Fixture fixture(config, pairs);
+    std::vector<LatencyHistogram> latency(threads);
+    std::vector<std::thread> workers;
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            // One flow and driver per owned pair, visited round robin
+            std::vector<OrderFlow> flows;
+            std::vector<Driver> drivers;
+            flows.reserve(pairs);
+            for (size_t p = t; p < pairs; p += threads) {
+                flows.emplace_back(flowOptions(config, p));
+            }
+            for (size_t i = 0, p = t; p < pairs; ++i, p += threads) {
+                drivers.push_back(Driver{fixture, fixture.pairs[p], flows[i]});
+                drivers.back().seed(config.depth, 2);
+            }
+
+            ++ready;
+            while (!go) std::this_thread::yield();
+
+            for (size_t i = 0; i < perThread; ++i) {
+                Driver& driver = drivers[i % drivers.size()];
+                FlowEvent event = driver.flow.next();
+
+                auto start = Clock::now();
+                driver.apply(event);
+                latency[t].record(nanos(start, Clock::now()));
+            }
+        });
+    }
+
+    while (ready < threads) std::this_thread::yield();
+    auto start = Clock::now();
+    go = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = seconds(start, Clock::now());
+
+    LatencyHistogram total;
+    for (const auto& histogram : latency) {
+        total.merge(histogram);
+    }
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "threaded %zut/%zup", threads, pairs);
+    printRow(name, perThread * threads, elapsed, &total);
+    printStats(fixture.engine);
+}
+
+// Same flow through ShardedEngine: producers only enqueue, shard threads match
+void benchSharded(const Config& config) {
+    size_t producers = std::max<size_t>(config.threads, 1);
+    size_t pairs = std::max(config.pairs, producers);
+    size_t perThread = config.orders / producers;
+
+    ShardedEngine::Options options;
+    options.shardCount = producers;
+    options.pinThreads = false;
+    options.bookMemory = config.bookMemory;
+    ShardedEngine engine(options);
+
+    std::vector<std::string> names;
+    for (size_t p = 0; p < pairs; ++p) {
+        names.push_back("PAIR" + std::to_string(p) + "/USD");
+        engine.addTradingPair(names.back());
+    }
+    engine.start();
+
+    // Passive-only flow: a cancel needs the order ID, which only comes back
+    // in the callback on the shard thread, putting the producer in its
+    // critical path
+    std::atomic<uint64_t> completed{0};
+    auto onComplete = [&completed](SubmitResult, std::exception_ptr) { ++completed; };
+
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (size_t t = 0; t < producers; ++t) {
+        workers.emplace_back([&, t] {
+            FlowOptions flowConfig = flowOptions(config, t);
+            flowConfig.cancelRatio = 0;
+            OrderFlow flow(flowConfig);
+            PairSpec spec;
+            std::string user = "user" + std::to_string(t);
+
+            for (size_t i = 0; i < perThread; ++i) {
+                FlowEvent event = flow.next();
+                engine.submitOrder(user, names[(t + i * producers) % pairs], event.side, OrderType::LIMIT,
+                                   spec.toPrice(event.price), spec.toQuantity(event.quantity), onComplete);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    while (completed < perThread * producers) std::this_thread::yield();
+    double elapsed = seconds(start, Clock::now());
+    engine.stop();
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "sharded %zut/%zup", producers, pairs);
+    printRow(name, perThread * producers, elapsed);
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)(const Config&);
+};
+
+const Benchmark kBenchmarks[] = {
+    {"add", benchAdd},
+    {"cancel", benchCancel},
+    {"match", benchMatch},
+    {"mixed", benchMixed},
+    {"depth", benchDepth},
+    {"threaded", benchThreaded},
+    {"sharded", benchSharded},
+};
+
+void usage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s [options] [benchmark...]\n"
+        "Benchmarks: add cancel match mixed depth threaded sharded (default: all)\n"
+        "  --orders N            operations per benchmark (default 1000000)\n"
+        "  --depth N             ticks each side of mid for passive flow (100)\n"
+        "  --deep-levels N       levels per side for the depth benchmark (5000)\n"
+        "  --cancel-ratio R      share of events that cancel (0.3)\n"
+        "  --aggressive-ratio R  share of submits that cross (0.1)\n"
+        "  --threads N           submitting threads (4)\n"
+        "  --pairs N             trading pairs for threaded runs (8)\n"
+        "  --seed N              flow generator seed (1)\n"
+        "  --huge-pages          back book memory with 2 MB pages\n"
+        "  --numa-node N         take book memory from NUMA node N\n"
+        "  --prefault N          reserve and fault in room for N orders per book\n"
+        "  --quick               small run for smoke testing\n",
+        program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        auto value = [&] { return argv[++i]; };
+
+        if (arg == "--orders" && hasValue) {
+            config.orders = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--depth" && hasValue) {
+            config.depth = static_cast<uint32_t>(std::strtoul(value(), nullptr, 10));
+        } else if (arg == "--deep-levels" && hasValue) {
+            config.deepLevels = static_cast<uint32_t>(std::strtoul(value(), nullptr, 10));
+        } else if (arg == "--cancel-ratio" && hasValue) {
+            config.cancelRatio = std::strtod(value(), nullptr);
+        } else if (arg == "--aggressive-ratio" && hasValue) {
+            config.aggressiveRatio = std::strtod(value(), nullptr);
+        } else if (arg == "--threads" && hasValue) {
+            config.threads = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--pairs" && hasValue) {
+            config.pairs = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            config.seed = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--huge-pages") {
+            config.bookMemory.arena.hugePages = true;
+        } else if (arg == "--numa-node" && hasValue) {
+            config.bookMemory.arena.numaNode = std::atoi(value());
+        } else if (arg == "--prefault" && hasValue) {
+            config.bookMemory.reserveOrders = std::strtoull(value(), nullptr, 10);
+            config.bookMemory.arena.prefault = config.bookMemory.reserveOrders != 0;
+        } else if (arg == "--quick") {
+            config.orders = 20000;
+            config.deepLevels = 500;
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            config.only.push_back(arg);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (config.orders == 0 || config.depth == 0 || config.deepLevels == 0) {
+        std::fprintf(stderr, "--orders, --depth and --deep-levels must be positive\n");
+        return 2;
+    }
+
+    for (const std::string& name : config.only) {
+        bool known = std::any_of(std::begin(kBenchmarks), std::end(kBenchmarks),
+                                 [&](const Benchmark& b) { return name == b.name; });
+        if (!known) {
+            std::fprintf(stderr, "Unknown benchmark: %s\n", name.c_str());
+            return 2;
+        }
+    }
+
+    std::printf("=== DEX engine benchmarks ===\n");
+    std::printf("orders %zu, depth %u, cancel ratio %.2f, aggressive ratio %.2f, "
+                "threads %zu, pairs %zu, seed %llu\n",
+                config.orders, config.depth, config.cancelRatio, config.aggressiveRatio,
+                config.threads, config.pairs, static_cast<unsigned long long>(config.seed));
+    if (config.bookMemory.arena.hugePages || config.bookMemory.arena.numaNode >= 0 ||
+        config.bookMemory.arena.prefault) {
+        std::printf("book memory: %s pages, NUMA node %d, %zu orders prefaulted\n",
+                    config.bookMemory.arena.hugePages ? "2 MB" : "4 KB",
+                    config.bookMemory.arena.numaNode, config.bookMemory.reserveOrders);
+    }
+    std::printf("latencies in ns\n\n");
+    printHeader();
+
+    try {
+        for (const Benchmark& benchmark : kBenchmarks) {
+            if (config.only.empty() ||
+                std::find(config.only.begin(), config.only.end(), benchmark.name) != config.only.end()) {
+                benchmark.run(config);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,408 @@
+#include "LatencyHistogram.hpp"
+#include "../include/Journal.hpp"
+#include "../include/MatchingEngine.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace DEX;
+
+// Drive a MatchingEngine from a recorded order event file, at the pace it
+// was recorded or as fast as possible, and report throughput and
+// per-message latency.
+//
+// Input is either a journal written by Journal (detected by its header) or a
+// CSV file with one event per line:
+//
+//   timestamp_ns,NEW,order_id,pair,user,side,type,price,quantity[,tif[,stop_price]]
+//   timestamp_ns,CANCEL,order_id
+//   timestamp_ns,AMEND,order_id,price,quantity
+//
+// order_id is the ID in the recording; the engine assigns its own and the
+// tool maps between them. Journals carry no timestamps and always replay
+// at full speed.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+    enum class Kind : uint8_t { NEW, CANCEL, AMEND };
+
+    Kind kind = Kind::NEW;
+    int64_t timestamp = 0;      // Recording time, nanoseconds
+    uint64_t orderId = 0;       // Recorded ID
+    PairId pairId = 0;
+    UserId userId = 0;
+    OrderSide side = OrderSide::BUY;
+    OrderType type = OrderType::LIMIT;
+    TimeInForce timeInForce = TimeInForce::GTC;
+    double price = 0;
+    double quantity = 0;
+    double stopPrice = 0;       // STOP and STOP_LIMIT only
+};
+
+struct Recording {
+    std::vector<Event> events;
+    bool timed = false;
+};
+
+std::string upper(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return value;
+}
+
+OrderSide parseSide(const std::string& value) {
+    std::string side = upper(value);
+    if (side == "BUY") return OrderSide::BUY;
+    if (side == "SELL") return OrderSide::SELL;
+    throw std::invalid_argument("Unknown side: " + value);
+}
+
+OrderType parseType(const std::string& value) {
+    std::string type = upper(value);
+    if (type == "LIMIT") return OrderType::LIMIT;
+    if (type == "MARKET") return OrderType::MARKET;
+    if (type == "POST_ONLY") return OrderType::POST_ONLY;
+    if (type == "STOP") return OrderType::STOP;
+    if (type == "STOP_LIMIT") return OrderType::STOP_LIMIT;
+    throw std::invalid_argument("Unknown order type: " + value);
+}
+
+TimeInForce parseTimeInForce(const std::string& value) {
+    std::string tif = upper(value);
+    if (tif.empty() || tif == "GTC") return TimeInForce::GTC;
+    if (tif == "IOC") return TimeInForce::IOC;
+    if (tif == "FOK") return TimeInForce::FOK;
+    throw std::invalid_argument("Unknown time in force: " + value);
+}
+
+bool isJournal(const std::string& path) {
+    char magic[8] = {};
+    std::ifstream in(path, std::ios::binary);
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, "DEXJRNL", 8) == 0;
+}
+
+// Pairs and users are created while loading, so the timed run only submits
+Recording loadCsv(const std::string& path, MatchingEngine& engine, const PairSpec& defaultSpec) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    Recording recording;
+    recording.timed = true;
+
+    std::string line;
+    size_t lineNumber = 0;
+    std::vector<std::string> fields;
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#' || line.compare(0, 9, "timestamp") == 0) continue;
+
+        fields.clear();
+        std::stringstream stream(line);
+        for (std::string field; std::getline(stream, field, ',');) {
+            fields.push_back(field);
+        }
+
+        try {
+            if (fields.size() < 3) {
+                throw std::invalid_argument("Too few fields");
+            }
+
+            Event event;
+            event.timestamp = std::stoll(fields[0]);
+            event.orderId = std::stoull(fields[2]);
+            std::string kind = upper(fields[1]);
+
+            if (kind == "NEW" && fields.size() >= 9 && fields.size() <= 11) {
+                event.kind = Event::Kind::NEW;
+                event.pairId = engine.getPairId(fields[3]);
+                if (event.pairId == MatchingEngine::kInvalidPairId) {
+                    event.pairId = engine.addTradingPair(fields[3], defaultSpec);
+                }
+                event.userId = engine.internUser(fields[4]);
+                event.side = parseSide(fields[5]);
+                event.type = parseType(fields[6]);
+                event.price = std::stod(fields[7]);
+                event.quantity = std::stod(fields[8]);
+                event.timeInForce = parseTimeInForce(fields.size() >= 10 ? fields[9] : "");
+                event.stopPrice = fields.size() == 11 ? std::stod(fields[10]) : 0;
+            } else if (kind == "CANCEL" && fields.size() == 3) {
+                event.kind = Event::Kind::CANCEL;
+            } else if (kind == "AMEND" && fields.size() == 5) {
+                event.kind = Event::Kind::AMEND;
+                event.price = std::stod(fields[3]);
+                event.quantity = std::stod(fields[4]);
+            } else {
+                throw std::invalid_argument("Unknown event or wrong field count");
+            }
+
+            recording.events.push_back(event);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+
+    return recording;
+}
+
+Recording loadJournal(const std::string& path, MatchingEngine& engine) {
+    Recording recording;
+    std::unordered_map<PairId, PairId> pairs;   // Journal ID -> engine ID
+    std::unordered_map<UserId, UserId> users;
+
+    JournalReader reader(path);
+    JournalRecord record;
+
+    while (reader.next(record)) {
+        Event event;
+        event.orderId = record.orderId;
+
+        switch (record.type) {
+        case JournalRecord::Type::PAIR:
+            pairs[record.pairId] = engine.addTradingPair(record.name, record.spec);
+            if (pairs[record.pairId] == MatchingEngine::kInvalidPairId) {
+                pairs[record.pairId] = engine.getPairId(record.name);
+            }
+            continue;
+
+        case JournalRecord::Type::USER:
+            users[record.userId] = engine.internUser(record.name);
+            continue;
+
+        case JournalRecord::Type::SUBMIT:
+            event.kind = Event::Kind::NEW;
+            event.userId = users.at(record.userId);
+            event.side = record.side;
+            event.type = record.orderType;
+            // Recorded expiry times have passed by now; the recorded
+            // expiries replay as cancels instead
+            event.timeInForce = record.timeInForce == TimeInForce::GTD ? TimeInForce::GTC
+                                                                       : record.timeInForce;
+            break;
+
+        case JournalRecord::Type::CANCEL:
+        case JournalRecord::Type::EXPIRE:
+            event.kind = Event::Kind::CANCEL;
+            break;
+
+        case JournalRecord::Type::AMEND:
+            event.kind = Event::Kind::AMEND;
+            break;
+        }
+
+        // Back to the external representation the engine API takes
+        auto pair = pairs.find(record.pairId);
+        if (pair == pairs.end()) {
+            throw std::runtime_error("Journal references an unknown trading pair");
+        }
+        const PairSpec& spec = engine.getOrderBook(pair->second)->getSpec();
+        event.pairId = pair->second;
+        event.price = spec.toPrice(record.price);
+        event.quantity = spec.toQuantity(record.quantity);
+        event.stopPrice = spec.toPrice(record.stopPrice);
+
+        recording.events.push_back(event);
+    }
+
+    return recording;
+}
+
+struct Placed {
+    uint64_t orderId;   // Engine ID
+    PairId pairId;
+};
+
+struct Report {
+    LatencyHistogram latency[3];   // By Event::Kind
+    LatencyHistogram lag;          // Start behind schedule, paced runs only
+    uint64_t trades = 0;
+    uint64_t rejected = 0;         // Invalid orders, refused cancels and amends
+    uint64_t unknown = 0;          // Cancels and amends of IDs never seen
+    double elapsed = 0;
+};
+
+void run(MatchingEngine& engine, const Recording& recording, bool paced, double speed, Report& report) {
+    std::unordered_map<uint64_t, Placed> placed;
+    placed.reserve(recording.events.size());
+
+    auto countTrade = [&report](const Trade&) { ++report.trades; };
+    const int64_t origin = recording.events.empty() ? 0 : recording.events.front().timestamp;
+    const auto begin = Clock::now();
+
+    for (const Event& event : recording.events) {
+        if (paced) {
+            auto due = begin + std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(event.timestamp - origin) / speed));
+
+            // Sleep through long gaps, spin the last stretch for accuracy
+            auto now = Clock::now();
+            if (due - now > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+            }
+            while ((now = Clock::now()) < due) {}
+
+            report.lag.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()));
+        }
+
+        auto start = Clock::now();
+        bool accepted = true;
+
+        if (event.kind == Event::Kind::NEW) {
+            try {
+                OrderResult result = isStop(event.type)
+                    ? engine.submitStopOrder(event.pairId, event.userId, event.side, event.type,
+                                             event.stopPrice, event.price, event.quantity,
+                                             countTrade, event.timeInForce)
+                    : engine.submitOrder(event.pairId, event.userId, event.side, event.type,
+                                         event.price, event.quantity, countTrade,
+                                         event.timeInForce);
+                placed[event.orderId] = Placed{result.orderId, event.pairId};
+                accepted = result.status != OrderStatus::REJECTED;
+            } catch (const std::invalid_argument&) {
+                accepted = false;
+            }
+        } else {
+            auto it = placed.find(event.orderId);
+            if (it == placed.end()) {
+                ++report.unknown;
+                continue;
+            }
+            if (event.kind == Event::Kind::CANCEL) {
+                accepted = engine.cancelOrder(it->second.orderId, it->second.pairId);
+            } else {
+                try {
+                    accepted = engine.amendOrder(it->second.orderId, it->second.pairId,
+                                                 event.price, event.quantity, countTrade);
+                } catch (const std::invalid_argument&) {
+                    accepted = false;
+                }
+            }
+        }
+
+        auto end = Clock::now();
+        report.latency[static_cast<size_t>(event.kind)].record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        report.rejected += !accepted;
+    }
+
+    report.elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+void printLatency(const char* name, const LatencyHistogram& histogram) {
+    if (histogram.count() == 0) return;
+
+    std::printf("%-10s %10llu %9.1f %8llu %8llu %8llu %9llu\n", name,
+                static_cast<unsigned long long>(histogram.count()), histogram.mean(),
+                static_cast<unsigned long long>(histogram.percentile(0.50)),
+                static_cast<unsigned long long>(histogram.percentile(0.99)),
+                static_cast<unsigned long long>(histogram.percentile(0.999)),
+                static_cast<unsigned long long>(histogram.max()));
+}
+
+void usage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s [options] <events.csv | journal>\n"
+        "  --pace original|max   replay at recorded pace or full speed (default max)\n"
+        "  --speed X             with --pace original, run X times faster (1)\n"
+        "  --tick T --lot L      spec for pairs first seen in a CSV (0.01, 0.0001)\n",
+        program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool paced = false;
+    double speed = 1.0;
+    PairSpec spec;
+    std::string path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--pace" && hasValue) {
+            std::string pace = argv[++i];
+            if (pace != "original" && pace != "max") {
+                usage(argv[0]);
+                return 2;
+            }
+            paced = pace == "original";
+        } else if (arg == "--speed" && hasValue) {
+            speed = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--tick" && hasValue) {
+            spec.tickSize = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--lot" && hasValue) {
+            spec.lotSize = std::strtod(argv[++i], nullptr);
+        } else if (arg[0] != '-' && path.empty()) {
+            path = arg;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (path.empty() || !(speed > 0) || !spec.isValid()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    MatchingEngine engine;
+    Recording recording;
+    Report report;
+
+    try {
+        bool journal = isJournal(path);
+        recording = journal ? loadJournal(path, engine) : loadCsv(path, engine, spec);
+        if (paced && !recording.timed) {
+            std::cerr << "Journals have no timestamps; replaying at full speed" << std::endl;
+            paced = false;
+        }
+
+        std::cout << "=== Load generator: " << path << " ===" << std::endl;
+        std::cout << "Format: " << (journal ? "journal" : "csv")
+                  << " | Events: " << recording.events.size()
+                  << " | Pairs: " << engine.getTradingPairCount()
+                  << " | Pace: " << (paced ? "original" : "max");
+        if (paced) std::cout << " x" << speed;
+        std::cout << std::endl;
+
+        run(engine, recording, paced, speed, report);
+    } catch (const std::exception& e) {
+        std::cerr << "Load generation failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    size_t events = recording.events.size();
+    std::printf("\nElapsed: %.3f s | Throughput: %.0f msg/s | Trades: %llu | "
+                "Rejected: %llu | Unknown IDs: %llu\n\n",
+                report.elapsed, report.elapsed > 0 ? static_cast<double>(events) / report.elapsed : 0.0,
+                static_cast<unsigned long long>(report.trades),
+                static_cast<unsigned long long>(report.rejected),
+                static_cast<unsigned long long>(report.unknown));
+
+    std::printf("%-10s %10s %9s %8s %8s %8s %9s   (ns)\n",
+                "message", "count", "mean", "p50", "p99", "p99.9", "max");
+    printLatency("new", report.latency[static_cast<size_t>(Event::Kind::NEW)]);
+    printLatency("cancel", report.latency[static_cast<size_t>(Event::Kind::CANCEL)]);
+    printLatency("amend", report.latency[static_cast<size_t>(Event::Kind::AMEND)]);
+    printLatency("lag", report.lag);
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace DEX {
+
+// Memory for the containers of one book: its order pool, ID index, price
+// ladder windows, per-user order lists, recent order ring and level-2 feed
+// ring. Only the ladder overflow levels stay on the heap.
+//
+// With default Options every request goes straight to the heap. Turning on
+// any option switches the arena to mapping its own 2 MB aligned regions:
+// small requests are carved out of the current region, large ones (more
+// than half a region) get a mapping of their own. Each mapping is
+//   - backed by 2 MB pages with hugePages: reserved hugetlbfs pages if the
+//     system has any, transparent huge pages otherwise, so a book's hot
+//     memory sits under a handful of TLB entries;
+//   - bound to numaNode before anything touches it, so the pages come from
+//     that node whichever thread first writes them;
+//   - faulted in as soon as it's mapped with prefault, so the page faults
+//     happen when the book is set up instead of in the first burst.
+// Small requests are rounded up to a power-of-two size class of at least
+// 64 bytes. A freed small block goes on its class's free list and serves
+// the next request of that class, so a resized ring or an index that
+// doubles hands its old memory back instead of stranding it. Regions
+// themselves are returned only with the arena; large blocks are unmapped
+// as soon as they are freed.
+class BookArena {
+public:
+    static constexpr size_t kRegionBytes = size_t(2) << 20;   // One huge page
+
+    struct Options {
+        bool hugePages = false;   // Back mappings with 2 MB pages
+        int numaNode = -1;        // NUMA node to take pages from, -1 = first touch
+        bool prefault = false;    // Fault every page in when it's mapped
+    };
+
+    explicit BookArena(const Options& options);
+    ~BookArena();
+
+    BookArena(const BookArena&) = delete;
+    BookArena& operator=(const BookArena&) = delete;
+
+    // Throws std::invalid_argument for a NUMA node this machine doesn't have
+    static void validate(const Options& options);
+
+    // Throws std::bad_alloc when out of memory
+    void* allocate(size_t bytes, size_t alignment);
+    void deallocate(void* memory, size_t bytes, size_t alignment);
+
+    const Options& options() const { return options_; }
+
+    // Bytes mapped so far (0 while requests go to the heap)
+    size_t mappedBytes() const { return mappedBytes_; }
+
+    // NUMA nodes on this machine (1 without NUMA), and the node a CPU
+    // belongs to (-1 if unknown)
+    static int nodeCount();
+    static int nodeOfCpu(size_t cpu);
+
+private:
+    struct Mapping {
+        char* memory;
+        size_t bytes;
+    };
+
+    // A freed small block, linked through its first bytes
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr unsigned kMinClassBits = 6;    // 64 bytes
+    static constexpr unsigned kClassCount = 21 - kMinClassBits;   // Up to half a region
+
+    Options options_;
+    bool mapped_;                     // Any option set, so not the heap
+    std::vector<Mapping> regions_;    // Shared regions small blocks come from
+    std::vector<Mapping> large_;      // One per large block
+    char* cursor_ = nullptr;          // Free space in the current region
+    char* end_ = nullptr;
+    size_t mappedBytes_ = 0;
+    FreeBlock* free_[kClassCount] = {};   // Per size class
+
+    static unsigned sizeClass(size_t bytes);
+    char* carve(size_t bytes, size_t alignment);
+    char* map(size_t bytes);
+    void unmap(const Mapping& mapping);
+};
+
+// Standard allocator over a BookArena, or over the heap if arena is nullptr,
+// for containers that may live inside a book or on their own
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    BookArena* arena = nullptr;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(BookArena* arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        if (!arena) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* memory, size_t count) {
+        if (!arena) {
+            ::operator delete(memory, std::align_val_t(alignof(T)));
+            return;
+        }
+        arena->deallocate(memory, count * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+} // namespace DEX
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "PairSpec.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace DEX {
+
+// Aggregated quantity resting at one price
+struct DepthLevel {
+    Price price;
+    Quantity quantity;
+    uint32_t orderCount;
+};
+
+// Immutable top-of-book and depth picture published after every change to
+// an OrderBook. All fields describe the same book state.
+struct BookSnapshot {
+    static constexpr size_t kDepth = 10;
+
+    uint64_t version = 0;   // Number of book mutations so far
+    Price bestBid = 0;      // 0 if there are no bids
+    Price bestAsk = 0;      // 0 if there are no asks
+    uint32_t bidLevels = 0; // Valid entries in bids
+    uint32_t askLevels = 0; // Valid entries in asks
+    DepthLevel bids[kDepth] = {};
+    DepthLevel asks[kDepth] = {};
+};
+
+} // namespace DEX
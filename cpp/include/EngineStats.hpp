@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace DEX {
+
+// Hot-path instrumentation, compiled in with -DDEX_ENABLE_STATS (CMake
+// option DEX_ENABLE_STATS). When it is off every hook below reduces to
+// nothing: the timers and counters are empty inline code the optimizer
+// removes, and the stats structs simply stay zero. The structs themselves
+// are always present so the layout of OrderBook and MatchingEngine doesn't
+// depend on the flag.
+#ifdef DEX_ENABLE_STATS
+constexpr bool kStatsEnabled = true;
+#else
+constexpr bool kStatsEnabled = false;
+#endif
+
+// Timestamp counter; falls back to steady_clock nanoseconds off x86
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Heap allocations made by the calling thread so far. Counted by the
+// replacement operator new in EngineStats.cpp, only in stats builds.
+uint64_t threadAllocations();
+
+// Time spent in one stage of order handling, in readCycles() units
+struct StageStats {
+    uint64_t count = 0;
+    uint64_t cycles = 0;
+
+    StageStats& operator+=(const StageStats& other) {
+        count += other.count;
+        cycles += other.cycles;
+        return *this;
+    }
+};
+
+struct LockStats {
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;     // Acquisitions that had to wait
+    uint64_t waitCycles = 0;    // Total time spent waiting
+
+    LockStats& operator+=(const LockStats& other) {
+        acquisitions += other.acquisitions;
+        contended += other.contended;
+        waitCycles += other.waitCycles;
+        return *this;
+    }
+};
+
+// Per-book counters. Only written with the book's lock held.
+struct BookStats {
+    LockStats lock;             // OrderBook::mutex_
+    StageStats match;           // Matching an incoming or amended order
+    StageStats rest;            // Resting the remainder in its level
+    StageStats publish;         // Publishing the book snapshot
+    uint64_t orders = 0;        // Orders inserted
+    uint64_t levelsTouched = 0; // Opposite price levels visited while matching
+    uint64_t trades = 0;        // One per resting order filled or partially filled
+    uint64_t allocations = 0;   // Heap allocations while inserting orders
+
+    BookStats& operator+=(const BookStats& other) {
+        lock += other.lock;
+        match += other.match;
+        rest += other.rest;
+        publish += other.publish;
+        orders += other.orders;
+        levelsTouched += other.levelsTouched;
+        trades += other.trades;
+        allocations += other.allocations;
+        return *this;
+    }
+};
+
+// Engine-wide view returned by MatchingEngine::getStats()
+struct EngineStats {
+    static constexpr bool kEnabled = kStatsEnabled;
+
+    uint64_t totalOrders = 0;       // Same as getTotalOrders()
+    size_t tradingPairCount = 0;    // Same as getTradingPairCount()
+
+    // Zero unless built with DEX_ENABLE_STATS
+    LockStats engineLock;           // MatchingEngine::mutex_
+    StageStats lookup;              // Resolving the pair name and user
+    StageStats prepare;             // Validating and converting to ticks/lots
+    BookStats books;                // Summed over every book
+};
+
+// StageStats updated from several threads at once
+struct SharedStageStats {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> cycles{0};
+
+    StageStats load() const { return StageStats{count.load(), cycles.load()}; }
+};
+
+// Adds the time from construction to destruction to a stage
+template <typename Stage = StageStats>
+class StageTimer {
+public:
+    explicit StageTimer(Stage& stage) : stage_(stage) {
+        if constexpr (kStatsEnabled) start_ = readCycles();
+    }
+
+    ~StageTimer() {
+        if constexpr (kStatsEnabled) {
+            uint64_t elapsed = readCycles() - start_;
+            if constexpr (std::is_same<Stage, SharedStageStats>::value) {
+                stage_.count.fetch_add(1, std::memory_order_relaxed);
+                stage_.cycles.fetch_add(elapsed, std::memory_order_relaxed);
+            } else {
+                ++stage_.count;
+                stage_.cycles += elapsed;
+            }
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Stage& stage_;
+    uint64_t start_ = 0;
+};
+
+// Adds the heap allocations made by this thread during its lifetime to a counter
+class AllocationCounter {
+public:
+    explicit AllocationCounter(uint64_t& counter) : counter_(counter) {
+        if constexpr (kStatsEnabled) start_ = threadAllocations();
+    }
+
+    ~AllocationCounter() {
+        if constexpr (kStatsEnabled) counter_ += threadAllocations() - start_;
+    }
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+private:
+    uint64_t& counter_;
+    uint64_t start_ = 0;
+};
+
+// std::lock_guard that records how long it waited. The counters are
+// updated once the lock is held, so they need no synchronization of their
+// own.
+class CountingLock {
+public:
+    CountingLock(std::mutex& mutex, LockStats& stats) : mutex_(mutex) {
+        if constexpr (kStatsEnabled) {
+            if (!mutex_.try_lock()) {
+                uint64_t start = readCycles();
+                mutex_.lock();
+                ++stats.contended;
+                stats.waitCycles += readCycles() - start;
+            }
+            ++stats.acquisitions;
+        } else {
+            mutex_.lock();
+        }
+    }
+
+    ~CountingLock() { mutex_.unlock(); }
+
+    CountingLock(const CountingLock&) = delete;
+    CountingLock& operator=(const CountingLock&) = delete;
+
+private:
+    std::mutex& mutex_;
+};
+
+} // namespace DEX
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "MpscQueue.hpp"
+#include "Order.hpp"
+#include "PairSpec.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DEX {
+
+// One accepted engine input, as written to and read back from a Journal.
+// Prices and quantities are in ticks and lots of the pair.
+struct JournalRecord {
+    enum class Type : uint8_t {
+        PAIR = 1,   // Trading pair definition: pairId, spec, name
+        USER,       // Interned user: userId, name
+        SUBMIT,     // New order: every order field
+        CANCEL,     // Successful cancel: pairId, orderId
+        AMEND,      // Successful amend: pairId, orderId, price, quantity
+        EXPIRE      // GTD order expired: pairId, orderId
+    };
+
+    uint64_t sequence = 0;   // Assigned by Journal::append, starts at 1
+    Type type = Type::SUBMIT;
+    PairId pairId = 0;
+    UserId userId = 0;
+    uint64_t orderId = 0;
+    OrderSide side = OrderSide::BUY;
+    OrderType orderType = OrderType::LIMIT;
+    TimeInForce timeInForce = TimeInForce::GTC;
+    Price price = 0;
+    Quantity quantity = 0;
+    Price stopPrice = 0;     // SUBMIT only
+    int64_t expireTime = 0;  // SUBMIT only, nanoseconds since the epoch
+    PairSpec spec;           // PAIR only
+    std::string name;        // PAIR and USER only
+};
+
+// Append-only binary write-ahead log of engine inputs.
+//
+// append() only claims a sequence number and pushes the record onto a
+// lock-free MPSC ring; a background writer thread drains the ring, encodes
+// everything available into one buffer and commits it with a single
+// write() and fdatasync() (group commit). Durability therefore never adds
+// I/O latency to the thread that appended.
+//
+// File layout (host byte order): a 16 byte header ("DEXJRNL\0", format
+// version, reserved), then frames of [payload length][FNV-1a checksum]
+// [payload]. A torn frame at the end of the file, left by a crash, is
+// dropped when the journal is reopened.
+class Journal {
+public:
+    struct Options {
+        size_t queueCapacity = 65536;      // Records in flight, power of two
+        size_t maxBatchBytes = 1 << 20;    // Upper bound on one group commit
+        bool sync = true;                  // fdatasync() after every commit
+    };
+
+    // Open or create a journal; new records go after the existing ones
+    explicit Journal(const std::string& path);
+    Journal(const std::string& path, const Options& options);
+
+    // Writes out everything appended, then closes the file
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Assign the next sequence number and queue the record. Blocks only
+    // while the ring is full; throws std::runtime_error if the writer has
+    // failed.
+    uint64_t append(JournalRecord&& record);
+
+    // Block until every record appended before the call is on disk.
+    // Throws std::runtime_error if the writer has failed.
+    void flush();
+
+    // Sequence number of the last appended record (0 if none)
+    uint64_t lastSequence() const { return sequence_.load(); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    Options options_;
+    int fd_ = -1;
+
+    MpscQueue<JournalRecord> queue_;
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> appended_{0};   // Records pushed onto queue_
+    std::atomic<uint64_t> written_{0};    // Records committed by the writer
+
+    std::thread writer_;
+    std::atomic<bool> running_{true};
+    std::atomic<bool> failed_{false};
+    std::atomic<size_t> producers_{0};    // Threads in the middle of append()
+
+    // Writer failure and flush() wakeups
+    std::mutex mutex_;
+    std::condition_variable committed_;
+    std::string error_;
+
+    void run();
+    bool commit(const std::vector<char>& buffer);
+};
+
+// Sequential reader for journal files
+class JournalReader {
+public:
+    // Throws std::runtime_error if the file can't be opened or isn't a journal
+    explicit JournalReader(const std::string& path);
+
+    // Read the next record. Returns false at the end of the journal or at a
+    // torn or corrupt frame, after which nothing more is read.
+    bool next(JournalRecord& record);
+
+    // Length of the file up to the end of the last good record
+    uint64_t validBytes() const { return validBytes_; }
+
+private:
+    std::ifstream in_;
+    std::vector<char> payload_;
+    uint64_t validBytes_ = 0;
+};
+
+} // namespace DEX
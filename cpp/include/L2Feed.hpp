@@ -0,0 +1,144 @@
+#pragma once
+
+#include "BookArena.hpp"
+#include "BookSnapshot.hpp"
+#include "Order.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace DEX {
+
+// New state of one price level. quantity 0 means the level is gone.
+struct L2Update {
+    uint64_t sequence = 0;   // Consecutive per book, starts at 1
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;         // Ticks
+    Quantity quantity = 0;   // Lots now resting at the price
+    uint32_t orderCount = 0;
+};
+
+// Every level of a book as of a point in its update stream; it reflects
+// updates up to and including `sequence`
+struct L2Snapshot {
+    uint64_t sequence = 0;
+    std::vector<DepthLevel> bids;   // Best first
+    std::vector<DepthLevel> asks;   // Best first
+};
+
+// Incremental level-2 market data for one book.
+//
+// The book publishes one update per price level it changes (coalesced
+// per level while matching, so a sweep reports each level once) into a
+// broadcast ring, and a full L2Snapshot every `snapshotInterval` updates.
+// There is one writer, the book under its lock, and any number of
+// L2Subscriber readers, each with its own cursor. Nothing a reader does
+// can slow the writer: a reader that falls a full ring behind finds its
+// next update overwritten and resyncs from the latest snapshot.
+class L2Feed {
+public:
+    struct Options {
+        size_t capacity = 1 << 16;        // Updates kept, power of two
+        size_t snapshotInterval = 4096;   // Updates between full snapshots
+    };
+
+    // The ring comes from arena if given (it must outlive the feed), from
+    // the heap otherwise
+    explicit L2Feed(const Options& options, BookArena* arena = nullptr);
+    ~L2Feed();
+
+    // Throws std::invalid_argument unless capacity is a power of two and
+    // snapshotInterval is between 1 and capacity / 4
+    static void validate(const Options& options);
+
+    L2Feed(const L2Feed&) = delete;
+    L2Feed& operator=(const L2Feed&) = delete;
+
+    // Writer side, called by the owning book with its lock held
+    void publish(OrderSide side, Price price, Quantity quantity, uint32_t orderCount) {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[sequence & mask_];
+
+        // Same protocol as Seqlock: odd stamp while writing, 2 * sequence once done
+        slot.stamp.store(2 * sequence - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.price.store(price, std::memory_order_relaxed);
+        slot.quantity.store(quantity, std::memory_order_relaxed);
+        slot.countAndSide.store(static_cast<uint64_t>(orderCount) << 8 |
+                                static_cast<uint64_t>(side), std::memory_order_relaxed);
+        slot.stamp.store(2 * sequence, std::memory_order_release);
+
+        sequence_.store(sequence, std::memory_order_release);
+    }
+
+    // Time for the book to call publishSnapshot()?
+    bool snapshotDue() const {
+        return sequence_.load(std::memory_order_relaxed) - snapshotSequence_ >= options_.snapshotInterval;
+    }
+
+    // Replace the latest snapshot; its sequence must be lastSequence()
+    void publishSnapshot(std::shared_ptr<const L2Snapshot> snapshot);
+
+    // Reader side, any thread
+
+    // Sequence of the last published update (0 if none)
+    uint64_t lastSequence() const { return sequence_.load(std::memory_order_acquire); }
+
+    std::shared_ptr<const L2Snapshot> latestSnapshot() const;
+
+    // Copy update `sequence` into out. Returns false if it was overwritten
+    // (or is being overwritten); the caller has fallen too far behind.
+    bool read(uint64_t sequence, L2Update& out) const;
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> stamp{0};
+        std::atomic<int64_t> price{0};
+        std::atomic<int64_t> quantity{0};
+        std::atomic<uint64_t> countAndSide{0};
+    };
+
+    Options options_;
+    size_t mask_;
+    ArenaAllocator<Slot> allocator_;
+    Slot* slots_;
+    alignas(64) std::atomic<uint64_t> sequence_{0};
+    uint64_t snapshotSequence_ = 0;       // Writer only
+    std::shared_ptr<const L2Snapshot> snapshot_;  // Through std::atomic_load/store
+};
+
+// One consumer's position in an L2Feed. Start from snapshot(), then apply
+// what poll() returns. The feed must outlive the subscriber.
+class L2Subscriber {
+public:
+    // Starts at the feed's latest snapshot
+    explicit L2Subscriber(const L2Feed& feed);
+
+    // The snapshot the subscriber last (re)synced from
+    const L2Snapshot& snapshot() const { return *snapshot_; }
+
+    // Copy up to maxUpdates new updates into out, in sequence, and return
+    // how many were copied. Returns 0 with needsResync() set if updates
+    // were overwritten before they were read.
+    size_t poll(L2Update* out, size_t maxUpdates);
+
+    bool needsResync() const { return lagged_; }
+
+    // Jump to the feed's latest snapshot, dropping anything unread
+    const L2Snapshot& resync();
+
+    // Next sequence poll() will return
+    uint64_t nextSequence() const { return next_; }
+
+private:
+    const L2Feed& feed_;
+    std::shared_ptr<const L2Snapshot> snapshot_;
+    uint64_t next_ = 1;
+    bool lagged_ = false;
+};
+
+} // namespace DEX
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "Journal.hpp"
 #include "OrderBook.hpp"
+#include "Settlement.hpp"
+#include "Snapshot.hpp"
+#include "SymbolTable.hpp"
 #include <map>
 #include <string>
 #include <memory>
@@ -9,28 +13,206 @@
 
 namespace DEX {
 
+// One order of a batch passed to MatchingEngine::submitOrders
+struct OrderRequest {
+    std::string userId;
+    std::string tradingPair;
+    OrderSide side;
+    OrderType type;
+    double price;
+    double quantity;
+    TimeInForce timeInForce = TimeInForce::GTC;
+    double stopPrice = 0;   // STOP and STOP_LIMIT only
+    std::chrono::system_clock::time_point expireTime{};   // GTD only
+};
+
+// Outcome of a single submitted order
+struct OrderResult {
+    uint64_t orderId;
+    OrderStatus status;  // See OrderBook::addOrder
+};
+
 class MatchingEngine {
 public:
+    static constexpr PairId kInvalidPairId = UINT32_MAX;
+    static constexpr size_t kMaxTradingPairs = 65536;
+
     MatchingEngine();
 
-    // Add a new trading pair
-    bool addTradingPair(const std::string& pair);
+    // Add a new trading pair with its tick and lot size. Returns its dense
+    // ID (0, 1, 2, ... in order of addition), or kInvalidPairId if a pair
+    // with that name already exists.
+    PairId addTradingPair(const std::string& pair, const PairSpec& spec = PairSpec{});
+
+    // Same, with the new book's memory placed as given instead of by the
+    // engine default (see setBookMemory)
+    PairId addTradingPair(const std::string& pair, const PairSpec& spec, const BookMemory& memory);
 
-    // Submit an order
+    // Memory placement for books created from now on, including those
+    // replayJournal and loadSnapshot create. Existing books keep theirs.
+    // Throws std::invalid_argument for an unknown NUMA node.
+    void setBookMemory(const BookMemory& memory);
+
+    // ID of a trading pair, or kInvalidPairId
+    PairId getPairId(const std::string& tradingPair) const;
+
+    // Submit an order. Price and quantity must lie on the pair's tick/lot
+    // grid. GTD orders take an expiry time in the future (see expireOrders).
     std::vector<Trade> submitOrder(const std::string& userId,
                                    const std::string& tradingPair,
                                    OrderSide side,
                                    OrderType type,
                                    double price,
-                                   double quantity);
+                                   double quantity,
+                                   TimeInForce timeInForce = TimeInForce::GTC,
+                                   std::chrono::system_clock::time_point expireTime = {});
+
+    // Same, reporting each fill to sink inline instead of collecting them,
+    // and returning the order's ID and status
+    OrderResult submitOrder(const std::string& userId,
+                            const std::string& tradingPair,
+                            OrderSide side,
+                            OrderType type,
+                            double price,
+                            double quantity,
+                            TradeSink sink,
+                            TimeInForce timeInForce = TimeInForce::GTC,
+                            std::chrono::system_clock::time_point expireTime = {});
+
+    // Submit directly to a book obtained from getOrderBook, skipping the
+    // pair lookup and user interning
+    std::vector<Trade> submitOrder(OrderBook& orderBook,
+                                   UserId userId,
+                                   OrderSide side,
+                                   OrderType type,
+                                   double price,
+                                   double quantity,
+                                   TimeInForce timeInForce = TimeInForce::GTC,
+                                   std::chrono::system_clock::time_point expireTime = {});
+
+    OrderResult submitOrder(OrderBook& orderBook,
+                            UserId userId,
+                            OrderSide side,
+                            OrderType type,
+                            double price,
+                            double quantity,
+                            TradeSink sink,
+                            TimeInForce timeInForce = TimeInForce::GTC,
+                            std::chrono::system_clock::time_point expireTime = {});
+
+    // Submit by pair and user ID; the book is found without any lock
+    std::vector<Trade> submitOrder(PairId pairId,
+                                   UserId userId,
+                                   OrderSide side,
+                                   OrderType type,
+                                   double price,
+                                   double quantity,
+                                   TimeInForce timeInForce = TimeInForce::GTC,
+                                   std::chrono::system_clock::time_point expireTime = {});
+
+    OrderResult submitOrder(PairId pairId,
+                            UserId userId,
+                            OrderSide side,
+                            OrderType type,
+                            double price,
+                            double quantity,
+                            TradeSink sink,
+                            TimeInForce timeInForce = TimeInForce::GTC,
+                            std::chrono::system_clock::time_point expireTime = {});
+
+    // Submit a STOP or STOP_LIMIT order: it waits until a trade prints at or
+    // through stopPrice, then enters as a market order (STOP, price ignored)
+    // or a limit order at price (STOP_LIMIT). See OrderBook::addOrder.
+    std::vector<Trade> submitStopOrder(const std::string& userId,
+                                       const std::string& tradingPair,
+                                       OrderSide side,
+                                       OrderType type,
+                                       double stopPrice,
+                                       double price,
+                                       double quantity,
+                                       TimeInForce timeInForce = TimeInForce::GTC,
+                                       std::chrono::system_clock::time_point expireTime = {});
+
+    OrderResult submitStopOrder(const std::string& userId,
+                                const std::string& tradingPair,
+                                OrderSide side,
+                                OrderType type,
+                                double stopPrice,
+                                double price,
+                                double quantity,
+                                TradeSink sink,
+                                TimeInForce timeInForce = TimeInForce::GTC,
+                                std::chrono::system_clock::time_point expireTime = {});
+
+    OrderResult submitStopOrder(PairId pairId,
+                                UserId userId,
+                                OrderSide side,
+                                OrderType type,
+                                double stopPrice,
+                                double price,
+                                double quantity,
+                                TradeSink sink,
+                                TimeInForce timeInForce = TimeInForce::GTC,
+                                std::chrono::system_clock::time_point expireTime = {});
+
+    // Submit a burst of orders. Requests are grouped by pair, each book is
+    // locked once and its orders match in arrival order. Trades are appended
+    // to trades, grouped by pair. The whole batch is validated before any
+    // order is executed; returns the number of trades appended.
+    size_t submitOrders(const OrderRequest* requests, size_t count, std::vector<Trade>& trades);
+    size_t submitOrders(const std::vector<OrderRequest>& requests, std::vector<Trade>& trades) {
+        return submitOrders(requests.data(), requests.size(), trades);
+    }
+    void submitOrders(const OrderRequest* requests, size_t count, TradeSink sink);
+
+    // Interned ID for a user, assigned on first use
+    UserId internUser(const std::string& userId) { return users_.intern(userId); }
 
     // Cancel an order
     bool cancelOrder(uint64_t orderId, const std::string& tradingPair);
+    bool cancelOrder(uint64_t orderId, PairId pairId);
+
+    // Expire every GTD order due by now, book by book (see
+    // OrderBook::expireOrders). Call from a timer, or at a session boundary;
+    // not during replay, where the journaled expiries are applied instead.
+    // Returns how many orders expired.
+    size_t expireOrders(std::chrono::system_clock::time_point now = std::chrono::system_clock::now());
+
+    // Copy of an open order, or of a recently filled, cancelled or rejected
+    // one (see OrderBook::getOrder). Returns false if it isn't known.
+    bool getOrder(uint64_t orderId, const std::string& tradingPair, Order& order) const;
+    bool getOrder(uint64_t orderId, PairId pairId, Order& order) const;
+
+    // Retired orders each book keeps for getOrder (default
+    // OrderBook::kDefaultRecentOrders), for existing and future pairs
+    void setRecentOrderCapacity(size_t capacity);
+
+    // Cancel-replace an open order under one book lock (see
+    // OrderBook::amendOrder). newQuantity is the new total quantity,
+    // including anything already filled; trades from a crossing amend go to
+    // trades or sink. Returns false if the order isn't open or the amend
+    // was refused.
+    bool amendOrder(uint64_t orderId, const std::string& tradingPair,
+                    double newPrice, double newQuantity, std::vector<Trade>& trades);
+    bool amendOrder(uint64_t orderId, const std::string& tradingPair,
+                    double newPrice, double newQuantity, TradeSink sink);
+    bool amendOrder(uint64_t orderId, PairId pairId,
+                    double newPrice, double newQuantity, std::vector<Trade>& trades);
+    bool amendOrder(uint64_t orderId, PairId pairId,
+                    double newPrice, double newQuantity, TradeSink sink);
 
     // Get orderbook for a trading pair
     std::shared_ptr<OrderBook> getOrderBook(const std::string& tradingPair);
 
-    // Get market data
+    // Book for a pair ID, or nullptr; lock-free. Books live as long as the engine.
+    OrderBook* getOrderBook(PairId pairId) const {
+        if (pairId >= pairCount_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return pairPages_[pairId / kPairPageSize][pairId % kPairPageSize];
+    }
+
+    // Get market data (converted back to the pair's price/quantity units)
     struct MarketData {
         double bestBid;
         double bestAsk;
@@ -40,23 +222,106 @@ public:
     };
 
     MarketData getMarketData(const std::string& tradingPair) const;
+    MarketData getMarketData(PairId pairId) const;
+
+    // Latest lock-free book snapshot, in ticks and lots
+    BookSnapshot getMarketSnapshot(const std::string& tradingPair) const;
+    BookSnapshot getMarketSnapshot(PairId pairId) const;
+
+    // Turn on incremental level-2 feeds (see L2Feed.hpp) for existing and
+    // future pairs. Books that already have a feed keep it.
+    void enableL2Feed(const L2Feed::Options& options = L2Feed::Options{});
+
+    // A pair's level-2 feed, or nullptr if feeds are off; subscribe with
+    // L2Subscriber. Throws std::runtime_error for an unknown pair.
+    const L2Feed* getL2Feed(const std::string& tradingPair) const;
+    const L2Feed* getL2Feed(PairId pairId) const;
+
+    // Get user's open orders in one pair
+    std::vector<Order> getUserOrders(const std::string& userId,
+                                     const std::string& tradingPair) const;
+    std::vector<Order> getUserOrders(UserId userId, PairId pairId) const;
 
-    // Get user's orders
-    std::vector<OrderPtr> getUserOrders(const std::string& userId,
-                                       const std::string& tradingPair) const;
+    // Get user's open orders across all pairs (see Order::pairId)
+    std::vector<Order> getUserOrders(const std::string& userId) const;
+
+    // Name behind an interned Order::userId
+    const std::string& getUserName(UserId userId) const { return users_.name(userId); }
+
+    // Log every pair, user and accepted order input to journal from now on
+    // (nullptr to detach). A journal with no records yet first receives the
+    // pairs and users defined so far; a non-empty one is assumed to have
+    // been replayed into this engine. Attach while no orders are in flight.
+    void attachJournal(Journal* journal);
+
+    // Hand every trade from now on to settlement for batching and Merkle
+    // commitment (nullptr to detach). Attach after replaying a journal so
+    // replayed trades aren't settled twice.
+    void attachSettlement(Settlement* settlement);
+
+    // Rebuild pairs, users and books by re-executing a journal, before any
+    // journal is attached. After loadSnapshot only the tail is applied:
+    // records a book already reflects are skipped. Returns the highest
+    // sequence number seen. Throws std::runtime_error if the journal
+    // doesn't fit this engine.
+    uint64_t replayJournal(const std::string& path);
+
+    // Write every pair, user and resting order to a flat snapshot file (see
+    // Snapshot.hpp). Books are copied one at a time under their own lock, so
+    // matching continues on the others; each book records the journal
+    // position it reflects. Safe to call while trading.
+    void saveSnapshot(const std::string& path) const;
+
+    // Restore a snapshot into an empty engine by mapping the file and
+    // resting its orders in place. Follow with replayJournal to apply what
+    // happened after the snapshot. Returns the journal sequence at which the
+    // save started.
+    uint64_t loadSnapshot(const std::string& path);
 
     // Statistics
     uint64_t getTotalOrders() const { return orderIdCounter_; }
-    size_t getTradingPairCount() const { return orderBooks_.size(); }
+    size_t getTradingPairCount() const { return pairCount_.load(); }
+
+    // Order and pair counts, plus lock, stage and matching counters summed
+    // over every book when built with DEX_ENABLE_STATS (see EngineStats.hpp)
+    EngineStats getStats() const;
+
+    // Names of all trading pairs, in PairId order
+    std::vector<std::string> getTradingPairs() const;
 
 private:
     std::map<std::string, std::shared_ptr<OrderBook>> orderBooks_;
+
+    // PairId -> book, readable without mutex_. Pages are allocated once and
+    // every slot is written before pairCount_ is raised past it, so readers
+    // that check pairCount_ first need no lock. Books are never removed.
+    static constexpr size_t kPairPageSize = 256;
+    std::unique_ptr<OrderBook*[]> pairPages_[kMaxTradingPairs / kPairPageSize];
+    std::atomic<PairId> pairCount_{0};
+    SymbolTable users_;
     std::atomic<uint64_t> orderIdCounter_;
     mutable std::mutex mutex_;
+    Journal* journal_ = nullptr;
+    Settlement* settlement_ = nullptr;
+    size_t recentOrderCapacity_ = OrderBook::kDefaultRecentOrders;
+    BookMemory bookMemory_;
+    bool l2FeedEnabled_ = false;
+    L2Feed::Options l2FeedOptions_;
+
+    // Instrumentation (see EngineStats.hpp); lockStats_ is written with mutex_ held
+    mutable LockStats lockStats_;
+    mutable SharedStageStats lookupStats_;
+    mutable SharedStageStats prepareStats_;
 
     uint64_t generateOrderId() {
         return ++orderIdCounter_;
     }
+
+    // Validate an order and convert it to the book's ticks/lots (no ID yet)
+    static NewOrder prepareOrder(const OrderBook& orderBook, UserId userId, OrderSide side,
+                                 OrderType type, double price, double quantity,
+                                 TimeInForce timeInForce, double stopPrice = 0,
+                                 std::chrono::system_clock::time_point expireTime = {});
 };
 
 } // namespace DEX
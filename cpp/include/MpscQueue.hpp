@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace DEX {
+
+// Bounded lock-free multi-producer queue (Vyukov's array queue).
+//
+// Each cell carries a sequence number telling producers and the consumer
+// whose turn it is, so a push or pop is one CAS on the shared index plus
+// an acquire/release handoff on the cell. Any number of threads may push;
+// pops must come from one consumer at a time.
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity)
+        : mask_(capacity - 1), cells_(new Cell[capacity]) {
+        if (capacity < 2 || (capacity & mask_) != 0) {
+            throw std::invalid_argument("Queue capacity must be a power of two");
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Returns false if the queue is full
+    bool tryPush(T&& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & mask_];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+
+        head_.store(pos + 1, std::memory_order_relaxed);
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+};
+
+} // namespace DEX
@@ -1,47 +1,75 @@
 #pragma once
 
-#include <string>
+#include "PairSpec.hpp"
 #include <chrono>
-#include <memory>
+#include <cstdint>
 
 namespace DEX {
 
-enum class OrderSide {
+// Interned identifiers (see SymbolTable and MatchingEngine::addTradingPair)
+using UserId = uint32_t;
+using PairId = uint32_t;
+
+enum class OrderSide : uint8_t {
     BUY,
     SELL
 };
 
-enum class OrderType {
+enum class OrderType : uint8_t {
     MARKET,
-    LIMIT
+    LIMIT,
+    POST_ONLY,  // Limit order that is rejected instead of crossing the book
+    STOP,       // Market order once the last trade price reaches stopPrice
+    STOP_LIMIT  // Limit order once the last trade price reaches stopPrice
 };
 
-enum class OrderStatus {
+// Waits for a trigger price before it matches (see OrderBook)
+inline bool isStop(OrderType type) {
+    return type == OrderType::STOP || type == OrderType::STOP_LIMIT;
+}
+
+enum class TimeInForce : uint8_t {
+    GTC,        // Good till cancelled: rest whatever doesn't fill
+    IOC,        // Immediate or cancel: fill what crosses, cancel the rest
+    FOK,        // Fill or kill: fill completely right away or not at all
+    GTD         // Good till date (or time): rest until expireTime, then expire
+};
+
+enum class OrderStatus : uint8_t {
     PENDING,
     PARTIAL,
     FILLED,
-    CANCELLED
+    CANCELLED,
+    REJECTED,   // Post-only order that would have crossed
+    EXPIRED     // GTD order whose expiry time passed while it was open
 };
 
+// Full state of an order, as returned by queries. Inside a book an order
+// is a RestingOrder plus its OrderDetails (see RestingOrder.hpp).
 struct Order {
     uint64_t id;
-    std::string userId;
-    std::string tradingPair;  // e.g., "ETH/USDT"
+    UserId userId;
+    PairId pairId;            // See MatchingEngine::getPairId
     OrderSide side;
     OrderType type;
+    TimeInForce timeInForce;
     OrderStatus status;
-    double price;             // Price per unit (0 for market orders)
-    double quantity;          // Original quantity
-    double filledQuantity;    // Quantity filled so far
+    Price price;              // Price per unit in ticks (0 for market orders)
+    Price stopPrice = 0;      // Trigger price in ticks (stop orders only)
+    Quantity quantity;        // Total quantity in lots (as last amended)
+    Quantity filledQuantity;  // Lots filled so far
     std::chrono::system_clock::time_point timestamp;
+    std::chrono::system_clock::time_point expireTime{};   // GTD only
 
-    Order(uint64_t id, const std::string& userId, const std::string& pair,
-          OrderSide side, OrderType type, double price, double quantity)
-        : id(id), userId(userId), tradingPair(pair), side(side), type(type),
-          status(OrderStatus::PENDING), price(price), quantity(quantity),
-          filledQuantity(0.0), timestamp(std::chrono::system_clock::now()) {}
+    Order(uint64_t id, UserId userId, PairId pairId,
+          OrderSide side, OrderType type, Price price, Quantity quantity,
+          std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now(),
+          TimeInForce timeInForce = TimeInForce::GTC)
+        : id(id), userId(userId), pairId(pairId), side(side), type(type),
+          timeInForce(timeInForce), status(OrderStatus::PENDING), price(price), quantity(quantity),
+          filledQuantity(0), timestamp(timestamp) {}
 
-    double getRemainingQuantity() const {
+    Quantity getRemainingQuantity() const {
         return quantity - filledQuantity;
     }
 
@@ -50,6 +78,4 @@ struct Order {
     }
 };
 
-using OrderPtr = std::shared_ptr<Order>;
-
 } // namespace DEX
@@ -1,65 +1,352 @@
 #pragma once
 
+#include "BookArena.hpp"
+#include "BookSnapshot.hpp"
+#include "EngineStats.hpp"
+#include "Journal.hpp"
+#include "L2Feed.hpp"
 #include "Order.hpp"
+#include "OrderIndex.hpp"
+#include "OrderPool.hpp"
+#include "PriceLadder.hpp"
+#include "RecentOrders.hpp"
+#include "Seqlock.hpp"
+#include "Settlement.hpp"
+#include "Snapshot.hpp"
+#include "TimerWheel.hpp"
+#include "TradeSink.hpp"
 #include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <functional>
 
 namespace DEX {
 
-struct Trade {
-    uint64_t buyOrderId;
-    uint64_t sellOrderId;
-    double price;
-    double quantity;
-    std::chrono::system_clock::time_point timestamp;
+// Fields of an order to be created by OrderBook, already validated and
+// converted to ticks/lots
+struct NewOrder {
+    uint64_t orderId;
+    UserId userId;
+    OrderSide side;
+    OrderType type;
+    Price price;
+    Quantity quantity;
+    TimeInForce timeInForce = TimeInForce::GTC;
+    Price stopPrice = 0;   // STOP and STOP_LIMIT only
+    int64_t expireTime = 0;   // GTD only, nanoseconds since the epoch
+};
+
+// Where a book keeps its orders, index and price levels, fixed when the
+// book is created (see BookArena)
+struct BookMemory {
+    BookArena::Options arena;
+    size_t reserveOrders = 0;   // Pool and index room set up front (faulted in with arena.prefault)
 };
 
 class OrderBook {
 public:
-    OrderBook(const std::string& tradingPair);
+    // Retired orders kept for getOrder() by default
+    static constexpr size_t kDefaultRecentOrders = 1024;
+
+    OrderBook(const std::string& tradingPair, const PairSpec& spec = PairSpec{},
+              PairId pairId = 0, const BookMemory& memory = BookMemory{});
+
+    // Create an order in the book's pool, match it and rest the remainder
+    std::vector<Trade> addOrder(uint64_t orderId, UserId userId, OrderSide side,
+                                OrderType type, Price price, Quantity quantity);
 
-    // Add order to the book
-    std::vector<Trade> addOrder(OrderPtr order);
+    // Same, reporting each fill to sink as it happens; never allocates once
+    // the book has warmed up. Returns the order's status afterwards:
+    // PENDING/PARTIAL if it rests, FILLED, CANCELLED if an IOC/FOK/market
+    // remainder was dropped, or REJECTED for a crossing post-only order.
+    //
+    // A STOP or STOP_LIMIT order waits, PENDING, until a trade prints at or
+    // through its stopPrice (at or above for buys, at or below for sells),
+    // then enters as a market or limit order; if the last trade price is
+    // already there, it enters right away. Stop orders triggered by a trade
+    // run before the call returns, and their fills go to the same sink.
+    OrderStatus addOrder(const NewOrder& order, TradeSink sink);
+
+    // Add several orders under one lock, in order, appending their trades.
+    // Returns the number of trades appended.
+    size_t addOrders(const NewOrder* orders, size_t count, std::vector<Trade>& trades);
+    void addOrders(const NewOrder* orders, size_t count, TradeSink sink);
 
     // Cancel an order
     bool cancelOrder(uint64_t orderId);
 
-    // Get current best bid and ask
-    double getBestBid() const;
-    double getBestAsk() const;
+    // Expire every GTD order whose expireTime is at or before now (to the
+    // millisecond, never early), resting or waiting on a stop, in one pass
+    // over the due slots of the book's timer wheel. Expired orders end
+    // EXPIRED and are journaled. Returns how many expired.
+    size_t expireOrders(std::chrono::system_clock::time_point now);
+
+    // Expire one open order now, as recorded in a journal (replay)
+    bool expireOrder(uint64_t orderId);
+
+    // Copy of an order by ID: a live order, or one of the most recent
+    // orders to have filled, been cancelled or been rejected. Returns false
+    // if the ID is unknown or has aged out of the recent-orders ring.
+    bool getOrder(uint64_t orderId, Order& order) const;
+
+    // Number of open orders: resting, or stop orders not yet triggered
+    size_t getOrderCount() const;
+
+    // Price of the last trade in ticks (0 before the first)
+    Price getLastPrice() const;
+
+    // How many retired orders getOrder() can still find (0 to keep none).
+    // Clears the ones kept so far.
+    void setRecentOrderCapacity(size_t capacity);
+
+    // Change a resting order's price and total quantity in place. A size-down
+    // at the same price keeps queue priority; any other amend moves the order
+    // to the back of its new level, matching first if the new price crosses.
+    // Shrinking to no more than the filled quantity cancels the order.
+    // Returns false if the order isn't open, is an untriggered stop order,
+    // or is post-only and would cross (it is then left unchanged).
+    bool amendOrder(uint64_t orderId, Price newPrice, Quantity newQuantity, TradeSink sink);
+    bool amendOrder(uint64_t orderId, Price newPrice, Quantity newQuantity,
+                    std::vector<Trade>& trades);
+
+    // Get current best bid and ask in ticks (0 if the side is empty).
+    // Lock-free, read from the latest snapshot.
+    Price getBestBid() const;
+    Price getBestAsk() const;
+
+    // Consistent top-of-book and depth, published after every change.
+    // Never blocks the matching thread.
+    BookSnapshot getSnapshot() const;
+
+    // Get market depth (price in ticks -> quantity in lots). Up to
+    // BookSnapshot::kDepth levels come from the snapshot without locking.
+    std::map<Price, Quantity> getBidDepth(int levels = 10) const;
+    std::map<Price, Quantity> getAskDepth(int levels = 10) const;
 
-    // Get market depth
-    std::map<double, double> getBidDepth(int levels = 10) const;
-    std::map<double, double> getAskDepth(int levels = 10) const;
+    // Allocation-free depth: writes up to maxLevels levels, best first,
+    // into out and returns how many were written. O(levels).
+    size_t getBidDepth(DepthLevel* out, size_t maxLevels) const;
+    size_t getAskDepth(DepthLevel* out, size_t maxLevels) const;
 
-    // Get all orders for a user
-    std::vector<OrderPtr> getUserOrders(const std::string& userId) const;
+    // Get all open orders for a user (copies, safe to keep after the book changes)
+    std::vector<Order> getUserOrders(UserId userId) const;
+
+    // Append a user's open orders to out and return how many were added
+    size_t appendUserOrders(UserId userId, std::vector<Order>& out) const;
+
+    // Append every accepted submit, cancel and amend to journal (nullptr to
+    // stop). Records are appended under the book lock, so the journal holds
+    // this book's inputs in execution order.
+    void setJournal(Journal* journal);
+
+    // Hand every trade to settlement as it executes (nullptr to stop)
+    void setSettlement(Settlement* settlement);
+
+    // Start publishing level-2 updates and periodic full snapshots. Does
+    // nothing if the feed is already on, so subscribers keep their feed.
+    void enableL2Feed(const L2Feed::Options& options = L2Feed::Options{});
+
+    // The book's level-2 feed, or nullptr if it was never enabled
+    const L2Feed* getL2Feed() const { return feed_.get(); }
+
+    // Sequence number of the last journal record applied to this book
+    uint64_t getJournalSequence() const;
+
+    // Record that the book now reflects the journal up to sequence (replay)
+    void markJournaled(uint64_t sequence);
+
+    // Copy the resting orders, bids best first then asks, each level in
+    // queue order, and the stop orders in trigger order, together with the
+    // journal position and last trade price they reflect
+    void exportImage(BookImage& image) const;
+
+    // Rest orders exported by exportImage in an empty book, in the order
+    // given, so every level gets its original queue order back
+    void restoreImage(const SnapshotOrder* orders, size_t count, uint64_t journalSequence,
+                      Price lastPrice);
+
+    // Instrumentation counters; all zero unless built with DEX_ENABLE_STATS
+    BookStats getStats() const;
+
+    // Bytes the book's arena has mapped (0 when it allocates from the heap)
+    size_t getMappedBytes() const;
 
     const std::string& getTradingPair() const { return tradingPair_; }
+    const PairSpec& getSpec() const { return spec_; }
+    PairId getPairId() const { return pairId_; }
 
 private:
     std::string tradingPair_;
+    PairSpec spec_;
+    PairId pairId_;
+
+    // Backs the pool, the index and the ladder windows, so declared first
+    BookArena arena_;
+
+    // Storage for every order in this book
+    OrderPool pool_{&arena_};
 
-    // Price -> Orders at that price
-    // For bids: higher price = better, so use std::greater
-    std::map<double, std::vector<OrderPtr>, std::greater<double>> bids_;
+    // Price -> Orders at that price, best level first
+    PriceLadder<OrderSide::BUY> bids_{PriceLadder<OrderSide::BUY>::kDefaultWindowTicks, &arena_};
+    PriceLadder<OrderSide::SELL> asks_{PriceLadder<OrderSide::SELL>::kDefaultWindowTicks, &arena_};
 
-    // For asks: lower price = better, so use std::less (default)
-    std::map<double, std::vector<OrderPtr>> asks_;
+    // Untriggered stop orders by stop price, threaded through the same
+    // queue links, next to trigger first: buy stops fire as the price rises,
+    // so the lowest first, and sell stops the highest first. Triggering
+    // only ever looks at the best level of each.
+    static constexpr size_t kStopWindowTicks = 256;
+    PriceLadder<OrderSide::SELL> buyStops_{kStopWindowTicks, &arena_};
+    PriceLadder<OrderSide::BUY> sellStops_{kStopWindowTicks, &arena_};
+    Price lastPrice_ = 0;   // Last trade price, 0 before the first
 
-    // Order ID -> Order (for quick lookup)
-    std::map<uint64_t, OrderPtr> orders_;
+    // Open GTD orders by expiry time, linked through OrderDetails::expiry.
+    // Orders join when they enter the book and leave in retireOrder.
+    struct ExpiryLink {
+        OrderPool* pool;
+        TimerLink<RestingOrder>& operator()(RestingOrder* order) const {
+            return pool->details(order).expiry;
+        }
+    };
+    TimerWheel<RestingOrder, ExpiryLink> expiries_{ExpiryLink{&pool_}};
 
-    // Thread safety
+    // Order ID -> Order, for live orders only. Orders leave the index and
+    // the pool as soon as they fill, are cancelled or are dropped, so both
+    // stay proportional to the resting book.
+    OrderIndex orders_{&arena_};
+
+    // Final state of the latest retired orders
+    RecentOrders recent_{kDefaultRecentOrders, &arena_};
+
+    // User -> open orders, threaded through OrderDetails::userPrev/userNext.
+    // A user's entry stays once their last order leaves, so resting again
+    // allocates nothing; there is at most one per user the engine has
+    // interned.
+    struct UserOrders {
+        RestingOrder* head = nullptr;
+        size_t count = 0;
+    };
+    using UserOrdersMap = std::unordered_map<UserId, UserOrders, std::hash<UserId>, std::equal_to<UserId>,
+                                             ArenaAllocator<std::pair<const UserId, UserOrders>>>;
+    UserOrdersMap userOrders_{0, UserOrdersMap::allocator_type(&arena_)};
+
+    // Thread safety. Guards every member of the book; the pool, ladders,
+    // index, expiry wheel, recent ring and arena have no locking of their
+    // own and are only touched with it held.
     mutable std::mutex mutex_;
 
-    // Try to match a new order with existing orders
-    std::vector<Trade> matchOrder(OrderPtr order);
+    // Written with mutex_ held (see EngineStats.hpp)
+    mutable BookStats stats_;
+
+    Journal* journal_ = nullptr;
+    uint64_t journalSequence_ = 0;
+    Settlement* settlement_ = nullptr;
+
+    // Level-2 update stream, off unless enabled
+    std::unique_ptr<L2Feed> feed_;
+
+    // Latest published view of the book, readable without mutex_
+    Seqlock<BookSnapshot> snapshot_;
+    uint64_t version_ = 0;
+
+    // Publish the current state to snapshot_ (call with mutex_ held)
+    void publishSnapshot();
+
+    // Report a level's new state to feed_, if on. Call after every change
+    // to a level and before erasing it once empty.
+    void publishLevel(OrderSide side, const PriceLevel& level) {
+        if (feed_) {
+            feed_->publish(side, level.price, level.totalQuantity, level.orderCount);
+        }
+    }
+
+    // Hand feed_ a full copy of both sides (call with mutex_ held)
+    void publishL2Snapshot();
+
+    std::map<Price, Quantity> getDepth(OrderSide side, int levels) const;
+    size_t getDepth(OrderSide side, DepthLevel* out, size_t maxLevels) const;
+
+    // Create, match and rest one order, then run any stop orders its trades
+    // triggered (call with mutex_ held)
+    OrderStatus insertOrder(const NewOrder& request, TradeSink sink);
+
+    // Match an order already in orders_ and rest, or retire, what's left
+    OrderStatus executeOrder(RestingOrder* order, TradeSink sink,
+                             std::chrono::system_clock::time_point now);
+
+    // Can a new order be filled completely right now? (fill-or-kill)
+    bool canFillNow(OrderSide side, OrderType type, Price price, Quantity quantity);
+
+    // Has the last trade price reached a stop order's trigger?
+    bool stopReached(OrderSide side, Price stopPrice) const {
+        return lastPrice_ != 0 && (side == OrderSide::BUY ? lastPrice_ >= stopPrice
+                                                          : lastPrice_ <= stopPrice);
+    }
+
+    // Take an open order out of its price level or stop ladder and its
+    // user's list, ready to retire
+    void removeOpenOrder(RestingOrder* order);
+
+    // Turn a stop order into the market or limit order it stands for and
+    // execute it
+    OrderStatus fireStop(RestingOrder* order, TradeSink sink);
+
+    // Fire triggered stop orders, one at a time and best trigger first, for
+    // as long as the trades they cause keep reaching more; buy stops go
+    // before sell stops. O(1) when nothing triggers.
+    void triggerStops(TradeSink sink);
+
+    // Would a new order on side S cross the opposite best price?
+    template <OrderSide S> bool wouldCross(Price price);
+
+    // Can a new order on side S be filled completely right now? Decided from
+    // the level aggregates without touching any order.
+    template <OrderSide S, OrderType T> bool canFill(Price price, Quantity quantity);
+
+    // Try to match a new order with existing orders. All of its fills share
+    // one timestamp, taken when the order arrived.
+    void matchOrder(RestingOrder& order, TradeSink sink, std::chrono::system_clock::time_point now);
+
+    // Matching kernel, specialized at compile time for the incoming side and
+    // order type so the loop carries no side/type branches
+    template <OrderSide S, OrderType T>
+    void match(RestingOrder& order, TradeSink sink, std::chrono::system_clock::time_point now);
+
+    // Side-generic helpers over bids_/asks_
+    template <OrderSide S> PriceLadder<S>& ladder();
+    template <OrderSide S> auto& stopLadder();
+    template <OrderSide S> void addStop(RestingOrder* order);
+    template <OrderSide S> void removeStop(RestingOrder* order);
+    template <OrderSide S> void rest(RestingOrder* order);
+    template <OrderSide S> void unlinkResting(RestingOrder* order);
+    template <OrderSide S> void detachFromLevel(RestingOrder* order);
+    template <OrderSide S>
+    bool amendResting(RestingOrder* order, Price newPrice, Quantity newQuantity, TradeSink sink);
+
+    // Record an accepted input in journal_, if set (call with mutex_ held)
+    void journalOrder(const NewOrder& order);
+    void journalChange(JournalRecord::Type type, uint64_t orderId,
+                       Price price = 0, Quantity quantity = 0);
+
+    // Take an order that is no longer resting out of orders_ and back to
+    // the pool, keeping its final state in recent_
+    void retireOrder(RestingOrder* order, OrderStatus status);
+
+    // Keep the final state of an order that never entered the book
+    void recordRejected(const NewOrder& request, OrderStatus status);
+
+    // Maintain userOrders_ as orders start and stop resting
+    void linkUserOrder(RestingOrder* order);
+    void unlinkUserOrder(RestingOrder* order);
+
+    // Public copy of an order in the book
+    Order toOrder(const RestingOrder& order) const;
 
     // Execute a trade between two orders
-    Trade executeTrade(OrderPtr buyOrder, OrderPtr sellOrder, double price, double quantity);
+    Trade executeTrade(RestingOrder& buyOrder, RestingOrder& sellOrder, Price price, Quantity quantity,
+                       std::chrono::system_clock::time_point now);
 };
 
 } // namespace DEX
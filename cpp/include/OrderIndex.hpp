@@ -0,0 +1,153 @@
+#pragma once
+
+#include "BookArena.hpp"
+#include "RestingOrder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace DEX {
+
+// Order ID -> T* map for one book, using open addressing.
+//
+// Slots hold the key and pointer inline in one flat array, probed
+// linearly, so a lookup is a multiply and usually a single cache line.
+// IDs are spread with Fibonacci hashing, which keeps the dense, increasing
+// IDs handed out by MatchingEngine on distinct slots. Erase shifts later
+// entries of the probe run back instead of leaving tombstones, so probe
+// lengths don't degrade under constant add/cancel churn. The table only
+// allocates when it doubles; inserts and erases otherwise never touch the
+// heap (or the book's arena, if given one).
+template <typename T>
+class IdIndex {
+public:
+    static constexpr size_t kMinCapacity = 1024;
+
+    explicit IdIndex(BookArena* arena = nullptr) : allocator_(arena) { rehash(kMinCapacity); }
+
+    ~IdIndex() { allocator_.deallocate(slots_, capacity()); }
+
+    IdIndex(const IdIndex&) = delete;
+    IdIndex& operator=(const IdIndex&) = delete;
+
+    // Entry with an ID, or nullptr
+    T* find(uint64_t id) const {
+        for (size_t slot = home(id);; slot = (slot + 1) & mask_) {
+            const Slot& entry = slots_[slot];
+            if (!entry.order) return nullptr;
+            if (entry.id == id) return entry.order;
+        }
+    }
+
+    bool contains(uint64_t id) const { return find(id) != nullptr; }
+
+    // Add an entry under its ID; returns false if the ID is already present
+    bool insert(uint64_t id, T* order) {
+        if ((size_ + 1) * 4 > capacity() * 3) {
+            rehash(capacity() * 2);
+        }
+
+        size_t slot = home(id);
+        for (; slots_[slot].order; slot = (slot + 1) & mask_) {
+            if (slots_[slot].id == id) return false;
+        }
+
+        slots_[slot] = Slot{id, order};
+        ++size_;
+        return true;
+    }
+
+    // Remove an ID; returns false if it wasn't present
+    bool erase(uint64_t id) {
+        size_t slot = home(id);
+        for (;; slot = (slot + 1) & mask_) {
+            if (!slots_[slot].order) return false;
+            if (slots_[slot].id == id) break;
+        }
+
+        // Backward-shift deletion: pull every later entry of the run that
+        // may legally sit in the hole into it, then empty the last hole
+        for (size_t next = (slot + 1) & mask_; slots_[next].order; next = (next + 1) & mask_) {
+            size_t want = home(slots_[next].id);
+            bool movable = slot <= next ? (want <= slot || want > next)
+                                        : (want <= slot && want > next);
+            if (movable) {
+                slots_[slot] = slots_[next];
+                slot = next;
+            }
+        }
+
+        slots_[slot] = Slot{};
+        --size_;
+        return true;
+    }
+
+    // Make sure at least `orders` entries fit without rehashing
+    void reserve(size_t orders) {
+        size_t capacity = this->capacity();
+        while (orders * 4 > capacity * 3) {
+            capacity *= 2;
+        }
+        if (capacity != this->capacity()) {
+            rehash(capacity);
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < capacity(); ++i) {
+            slots_[i] = Slot{};
+        }
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        uint64_t id = 0;
+        T* order = nullptr;  // nullptr marks an empty slot
+    };
+
+    ArenaAllocator<Slot> allocator_;
+    Slot* slots_ = nullptr;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    unsigned shift_ = 0;
+
+    size_t home(uint64_t id) const {
+        return static_cast<size_t>((id * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void rehash(size_t capacity) {
+        Slot* old = slots_;
+        size_t oldCapacity = old ? this->capacity() : 0;
+
+        slots_ = allocator_.allocate(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            new (&slots_[i]) Slot{};
+        }
+        mask_ = capacity - 1;
+        shift_ = 64 - static_cast<unsigned>(__builtin_ctzll(capacity));
+        size_ = 0;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (old[i].order) {
+                size_t slot = home(old[i].id);
+                while (slots_[slot].order) {
+                    slot = (slot + 1) & mask_;
+                }
+                slots_[slot] = old[i];
+                ++size_;
+            }
+        }
+        if (old) {
+            allocator_.deallocate(old, oldCapacity);
+        }
+    }
+};
+
+using OrderIndex = IdIndex<RestingOrder>;
+
+} // namespace DEX
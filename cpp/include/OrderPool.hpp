@@ -0,0 +1,128 @@
+#pragma once
+
+#include "BookArena.hpp"
+#include "RestingOrder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace DEX {
+
+// Slab allocator for the orders of one book.
+//
+// Orders are carved out of fixed-size chunks that are never returned to
+// the heap, so a RestingOrder* stays valid until the order is released,
+// and released slots are handed out again first. Once the pool has grown
+// to the book's working set, allocating an order doesn't touch the heap.
+//
+// Each slot is split in two: the RestingOrder itself, one cache line in a
+// chunk of contiguous lines, and its OrderDetails in a parallel array
+// indexed by the same slot number (RestingOrder::handle). The matching
+// loop only ever touches the first. Chunks come from the book's arena
+// (the heap without one).
+class OrderPool {
+public:
+    static constexpr size_t kChunkOrders = 4096;
+
+    explicit OrderPool(BookArena* arena = nullptr) : slots_(arena), details_(arena) {}
+
+    ~OrderPool() {
+        for (Slot* chunk : chunks_) {
+            slots_.deallocate(chunk, kChunkOrders);
+        }
+        for (OrderDetails* chunk : detailChunks_) {
+            details_.deallocate(chunk, kChunkOrders);
+        }
+    }
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    template <typename... Args>
+    RestingOrder* allocate(Args&&... args) {
+        if (free_.empty()) {
+            grow();
+        }
+
+        uint32_t handle = free_.back();
+        free_.pop_back();
+        ++liveCount_;
+
+        RestingOrder* order = new (slot(handle)) RestingOrder(std::forward<Args>(args)...);
+        order->handle = handle;
+        new (&detailChunks_[handle / kChunkOrders][handle % kChunkOrders]) OrderDetails{};
+        return order;
+    }
+
+    void release(RestingOrder* order) {
+        uint32_t handle = order->handle;
+        order->~RestingOrder();
+        // Never reallocates: grow() reserved room for every slot
+        free_.push_back(handle);
+        --liveCount_;
+    }
+
+    OrderDetails& details(const RestingOrder* order) {
+        return detailChunks_[order->handle / kChunkOrders][order->handle % kChunkOrders];
+    }
+
+    const OrderDetails& details(const RestingOrder* order) const {
+        return detailChunks_[order->handle / kChunkOrders][order->handle % kChunkOrders];
+    }
+
+    // Make sure at least `orders` can be live without growing
+    void reserve(size_t orders) {
+        while (capacity() < orders) {
+            grow();
+        }
+    }
+
+    size_t size() const { return liveCount_; }
+    size_t capacity() const { return chunks_.size() * kChunkOrders; }
+
+private:
+    struct alignas(RestingOrder) Slot {
+        unsigned char storage[sizeof(RestingOrder)];
+    };
+
+    // Slots and details are both constructed in allocate(), over whatever
+    // a released order left behind, so chunks are freed without destruction
+    static_assert(std::is_trivially_destructible<OrderDetails>::value,
+                  "OrderDetails chunks are freed without destruction");
+
+    ArenaAllocator<Slot> slots_;
+    ArenaAllocator<OrderDetails> details_;
+    std::vector<Slot*> chunks_;
+    std::vector<OrderDetails*> detailChunks_;
+
+    // Free slot numbers, most recently released last so they are reused
+    // while still in cache
+    std::vector<uint32_t> free_;
+    size_t liveCount_ = 0;
+
+    void* slot(uint32_t handle) {
+        return chunks_[handle / kChunkOrders][handle % kChunkOrders].storage;
+    }
+
+    void grow() {
+        if (capacity() + kChunkOrders > UINT32_MAX) {
+            throw std::length_error("Too many orders in one book");
+        }
+
+        size_t first = capacity();
+        chunks_.push_back(slots_.allocate(kChunkOrders));
+        detailChunks_.push_back(details_.allocate(kChunkOrders));
+        free_.reserve(capacity());
+
+        // Hand the new slots out in address order
+        for (size_t i = kChunkOrders; i-- > 0;) {
+            free_.push_back(static_cast<uint32_t>(first + i));
+        }
+    }
+};
+
+} // namespace DEX
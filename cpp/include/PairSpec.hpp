@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace DEX {
+
+// Prices are expressed in ticks and quantities in lots of the trading pair
+using Price = int64_t;
+using Quantity = int64_t;
+
+// Tick and lot size of a trading pair. Converts between the external
+// floating point representation and the integer values used by the book.
+struct PairSpec {
+    double tickSize = 0.01;     // Minimum price increment
+    double lotSize = 0.0001;    // Minimum quantity increment
+
+    Price toTicks(double price) const {
+        return static_cast<Price>(toUnits(price, tickSize, "Price is not a multiple of the tick size"));
+    }
+
+    Quantity toLots(double quantity) const {
+        return static_cast<Quantity>(toUnits(quantity, lotSize, "Quantity is not a multiple of the lot size"));
+    }
+
+    double toPrice(Price ticks) const { return static_cast<double>(ticks) * tickSize; }
+    double toQuantity(Quantity lots) const { return static_cast<double>(lots) * lotSize; }
+
+    bool isValid() const { return tickSize > 0 && lotSize > 0; }
+
+private:
+    static int64_t toUnits(double value, double unit, const char* error) {
+        double scaled = value / unit;
+        if (!(std::fabs(scaled) < 4.0e18)) {
+            throw std::invalid_argument("Value out of range for trading pair");
+        }
+
+        double rounded = std::round(scaled);
+        // Tolerate binary floating point noise, reject genuinely off-grid values
+        if (std::fabs(scaled - rounded) > 1e-6) {
+            throw std::invalid_argument(error);
+        }
+
+        return static_cast<int64_t>(rounded);
+    }
+};
+
+} // namespace DEX
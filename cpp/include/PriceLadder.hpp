@@ -0,0 +1,306 @@
+#pragma once
+
+#include "BookArena.hpp"
+#include "RestingOrder.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace DEX {
+
+// All resting orders at one price, as an intrusive FIFO queue threaded
+// through RestingOrder::prev/next. The level doesn't own the orders. It keeps a
+// running total of their remaining quantity, so depth queries never have
+// to walk the queue.
+struct PriceLevel {
+    Price price = 0;
+    RestingOrder* head = nullptr;
+    RestingOrder* tail = nullptr;
+    Quantity totalQuantity = 0;  // Sum of remaining quantity
+    uint32_t orderCount = 0;
+
+    PriceLevel() = default;
+    PriceLevel(const PriceLevel&) = delete;
+    PriceLevel& operator=(const PriceLevel&) = delete;
+
+    PriceLevel(PriceLevel&& other) noexcept { *this = std::move(other); }
+    PriceLevel& operator=(PriceLevel&& other) noexcept {
+        if (this != &other) {
+            price = other.price;
+            head = other.head;
+            tail = other.tail;
+            totalQuantity = other.totalQuantity;
+            orderCount = other.orderCount;
+            other.head = other.tail = nullptr;
+            other.totalQuantity = 0;
+            other.orderCount = 0;
+        }
+        return *this;
+    }
+
+    bool empty() const { return head == nullptr; }
+
+    void pushBack(RestingOrder* order) {
+        order->prev = tail;
+        order->next = nullptr;
+        if (tail) {
+            tail->next = order;
+        } else {
+            head = order;
+        }
+        tail = order;
+        totalQuantity += order->getRemainingQuantity();
+        ++orderCount;
+    }
+
+    void popFront() { unlink(head); }
+
+    // An order in this level was filled by quantity
+    void reduce(Quantity quantity) { totalQuantity -= quantity; }
+
+    void unlink(RestingOrder* order) {
+        totalQuantity -= order->getRemainingQuantity();
+        --orderCount;
+
+        if (order->prev) {
+            order->prev->next = order->next;
+        } else {
+            head = order->next;
+        }
+        if (order->next) {
+            order->next->prev = order->prev;
+        } else {
+            tail = order->prev;
+        }
+        order->prev = order->next = nullptr;
+    }
+};
+
+// One side of the book, indexed by price.
+//
+// Levels near the top of the book live in a contiguous window indexed by
+// tick distance, with an occupancy bitmap to find the next level quickly.
+// Prices too far from the top to fit in the window live in an overflow
+// tree. The window slides so that the best level is always inside it,
+// which means the overflow only ever holds levels worse than the window.
+// It also slides back once the best level drifts more than half a window
+// worse than where the last slide put it, so a market trending that way
+// keeps its new levels in the window instead of the overflow.
+//
+// Internally prices are mapped to a "rank" where a lower rank is always a
+// better price (rank = -price for bids, rank = price for asks), so both
+// sides share the same code.
+//
+// The window and its bitmap come from the book's arena (the heap without
+// one); overflow levels are cold and stay on the heap.
+template <OrderSide S>
+class PriceLadder {
+public:
+    static constexpr size_t kDefaultWindowTicks = 2048;
+
+    explicit PriceLadder(size_t windowTicks = kDefaultWindowTicks, BookArena* arena = nullptr)
+        : window_(roundUp(windowTicks), ArenaAllocator<PriceLevel>(arena)),
+          occupied_(window_.size() / 64, 0, ArenaAllocator<uint64_t>(arena)),
+          base_(0), bestIndex_(0), windowCount_(0) {}
+
+    bool empty() const { return windowCount_ == 0; }
+    size_t size() const { return windowCount_ + overflow_.size(); }
+
+    // Levels in the window rather than the overflow tree
+    size_t windowLevels() const { return windowCount_; }
+
+    // True if price a has priority over price b on this side
+    static bool isBetter(Price a, Price b) { return rankOf(a) < rankOf(b); }
+
+    // Best level, or nullptr if the side is empty
+    PriceLevel* best() { return empty() ? nullptr : &window_[bestIndex_]; }
+    const PriceLevel* best() const { return empty() ? nullptr : &window_[bestIndex_]; }
+
+    Price bestPrice() const { return empty() ? 0 : window_[bestIndex_].price; }
+
+    // Existing level at a price, or nullptr
+    PriceLevel* find(Price price) {
+        int64_t rank = rankOf(price);
+        if (inWindow(rank)) {
+            size_t index = static_cast<size_t>(rank - base_);
+            return isOccupied(index) ? &window_[index] : nullptr;
+        }
+
+        auto it = overflow_.find(rank);
+        return it == overflow_.end() ? nullptr : &it->second;
+    }
+
+    // Level at a price, created if it doesn't exist yet
+    PriceLevel& insert(Price price) {
+        int64_t rank = rankOf(price);
+
+        if (empty() || rank < base_) {
+            recenter(rank);
+        }
+
+        if (inWindow(rank)) {
+            size_t index = static_cast<size_t>(rank - base_);
+            PriceLevel& level = window_[index];
+            if (!isOccupied(index)) {
+                setOccupied(index);
+                level.price = price;
+                ++windowCount_;
+                if (windowCount_ == 1 || index < bestIndex_) {
+                    bestIndex_ = index;
+                }
+            }
+            return level;
+        }
+
+        PriceLevel& level = overflow_[rank];
+        level.price = price;
+        return level;
+    }
+
+    // Remove the (empty) level at a price
+    void erase(Price price) {
+        int64_t rank = rankOf(price);
+
+        if (!inWindow(rank)) {
+            overflow_.erase(rank);
+            return;
+        }
+
+        size_t index = static_cast<size_t>(rank - base_);
+        if (!isOccupied(index)) {
+            return;
+        }
+
+        clearOccupied(index);
+        --windowCount_;
+
+        if (index != bestIndex_) {
+            return;
+        }
+
+        if (windowCount_ > 0) {
+            bestIndex_ = nextOccupied(index + 1);
+            // Drifted half a window worse than the anchor: slide back
+            if (bestIndex_ >= anchor() + window_.size() / 2) {
+                recenter(base_ + static_cast<int64_t>(bestIndex_));
+            }
+        } else if (!overflow_.empty()) {
+            // The window ran dry; slide it onto the best overflow level
+            recenter(overflow_.begin()->first);
+        }
+    }
+
+    // Visit levels from best to worst until the callback returns false
+    template <typename F>
+    void forEach(F&& visit) const {
+        if (empty()) {
+            return;
+        }
+
+        for (size_t index = bestIndex_; index < window_.size();
+             index = nextOccupied(index + 1)) {
+            if (!visit(window_[index])) {
+                return;
+            }
+        }
+
+        for (const auto& [rank, level] : overflow_) {
+            if (!visit(level)) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::vector<PriceLevel, ArenaAllocator<PriceLevel>> window_;   // window_[i] holds rank base_ + i
+    std::vector<uint64_t, ArenaAllocator<uint64_t>> occupied_;     // One bit per window slot
+    int64_t base_;
+    size_t bestIndex_;                      // Valid while windowCount_ > 0
+    size_t windowCount_;                    // Occupied window slots
+    std::map<int64_t, PriceLevel> overflow_; // Ranks beyond the window
+
+    static int64_t rankOf(Price price) {
+        return S == OrderSide::BUY ? -price : price;
+    }
+
+    static size_t roundUp(size_t ticks) {
+        return std::max<size_t>(64, (ticks + 63) / 64 * 64);
+    }
+
+    bool inWindow(int64_t rank) const {
+        return rank >= base_ && rank - base_ < static_cast<int64_t>(window_.size());
+    }
+
+    bool isOccupied(size_t index) const {
+        return (occupied_[index / 64] >> (index % 64)) & 1;
+    }
+
+    void setOccupied(size_t index) { occupied_[index / 64] |= uint64_t(1) << (index % 64); }
+    void clearOccupied(size_t index) { occupied_[index / 64] &= ~(uint64_t(1) << (index % 64)); }
+
+    // First occupied slot at or after index, or window_.size() if none
+    size_t nextOccupied(size_t index) const {
+        size_t word = index / 64;
+        if (word >= occupied_.size()) {
+            return window_.size();
+        }
+
+        uint64_t bits = occupied_[word] & (~uint64_t(0) << (index % 64));
+        while (bits == 0) {
+            if (++word == occupied_.size()) {
+                return window_.size();
+            }
+            bits = occupied_[word];
+        }
+
+        return word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+    }
+
+    // Where recenter puts the best level: a quarter of the way in, leaving
+    // room for the price to improve without another slide
+    size_t anchor() const { return window_.size() / 4; }
+
+    // Slide the window so that bestRank sits at the anchor
+    void recenter(int64_t bestRank) {
+        const int64_t size = static_cast<int64_t>(window_.size());
+        const int64_t newBase = bestRank - static_cast<int64_t>(anchor());
+
+        // Levels that fall off the worse end of the window go to overflow
+        for (size_t index = nextOccupied(0); index < window_.size();
+             index = nextOccupied(index + 1)) {
+            int64_t rank = base_ + static_cast<int64_t>(index);
+            if (rank >= newBase + size) {
+                overflow_.emplace(rank, std::move(window_[index]));
+            }
+        }
+
+        // Rotate so every remaining level lands on its new slot. Slots that
+        // wrap around were emptied above, and level storage is reused.
+        int64_t shift = ((base_ - newBase) % size + size) % size;
+        std::rotate(window_.begin(), window_.end() - shift, window_.end());
+        base_ = newBase;
+
+        // Pull overflow levels that now fit inside the window
+        while (!overflow_.empty() && overflow_.begin()->first < base_ + size) {
+            auto it = overflow_.begin();
+            PriceLevel& slot = window_[static_cast<size_t>(it->first - base_)];
+            slot = std::move(it->second);
+            overflow_.erase(it);
+        }
+
+        std::fill(occupied_.begin(), occupied_.end(), 0);
+        windowCount_ = 0;
+        for (size_t index = 0; index < window_.size(); ++index) {
+            if (!window_[index].empty()) {
+                setOccupied(index);
+                ++windowCount_;
+            }
+        }
+        bestIndex_ = nextOccupied(0);
+    }
+};
+
+} // namespace DEX
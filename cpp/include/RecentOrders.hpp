@@ -0,0 +1,111 @@
+#pragma once
+
+#include "BookArena.hpp"
+#include "Order.hpp"
+#include "OrderIndex.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace DEX {
+
+// Final state of an order that has left the book
+struct OrderRecord {
+    uint64_t id;
+    UserId userId;
+    OrderSide side;
+    OrderType type;
+    TimeInForce timeInForce;
+    OrderStatus status;         // FILLED, CANCELLED, REJECTED or EXPIRED
+    Price price;
+    Quantity quantity;
+    Quantity filledQuantity;
+    std::chrono::system_clock::time_point timestamp;
+    Price stopPrice;
+    int64_t expireTime;         // Nanoseconds since the epoch, GTD only
+};
+
+// Bounded ring of the most recently retired orders of one book, indexed by
+// ID so status queries stay O(1). Once full, every new record overwrites
+// the oldest one. The ring is allocated on first use, so idle books pay
+// only for the empty index. Ring and index come from the book's arena (the
+// heap without one).
+class RecentOrders {
+public:
+    explicit RecentOrders(size_t capacity, BookArena* arena = nullptr)
+        : allocator_(arena), index_(arena), capacity_(capacity) {}
+
+    ~RecentOrders() { release(); }
+
+    RecentOrders(const RecentOrders&) = delete;
+    RecentOrders& operator=(const RecentOrders&) = delete;
+
+    // Change the capacity (0 keeps nothing); drops every record. A ring that
+    // already holds the new capacity is kept.
+    void setCapacity(size_t capacity) {
+        if (capacity > ringCapacity_) release();
+        index_.clear();
+        capacity_ = capacity;
+        next_ = 0;
+        size_ = 0;
+    }
+
+    void push(const OrderRecord& record) {
+        if (capacity_ == 0) return;
+
+        if (!ring_) {
+            ring_ = allocator_.allocate(capacity_);
+            std::uninitialized_default_construct_n(ring_, capacity_);
+            ringCapacity_ = capacity_;
+        }
+        if (size_ == 0) index_.reserve(capacity_);
+
+        OrderRecord* slot = &ring_[next_];
+        if (size_ == capacity_) {
+            // The evicted ID may have been reused by a newer record since
+            if (index_.find(slot->id) == slot) {
+                index_.erase(slot->id);
+            }
+        } else {
+            ++size_;
+        }
+
+        *slot = record;
+        if (!index_.insert(record.id, slot)) {
+            index_.erase(record.id);
+            index_.insert(record.id, slot);
+        }
+        next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+    }
+
+    // Record for an ID, or nullptr if it was never retired or has been overwritten
+    const OrderRecord* find(uint64_t id) const { return index_.find(id); }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static_assert(std::is_trivially_destructible<OrderRecord>::value,
+                  "The ring is freed without destroying its records");
+
+    ArenaAllocator<OrderRecord> allocator_;
+    OrderRecord* ring_ = nullptr;
+    IdIndex<OrderRecord> index_;
+    size_t capacity_;
+    size_t ringCapacity_ = 0;   // Records the ring has room for
+    size_t next_ = 0;
+    size_t size_ = 0;
+
+    void release() {
+        if (ring_) {
+            allocator_.deallocate(ring_, ringCapacity_);
+            ring_ = nullptr;
+            ringCapacity_ = 0;
+        }
+    }
+};
+
+} // namespace DEX
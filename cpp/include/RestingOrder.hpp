@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Order.hpp"
+#include "TimerWheel.hpp"
+#include <chrono>
+#include <cstdint>
+
+namespace DEX {
+
+// An order while it is inside a book, reduced to what matching reads and
+// writes. Exactly one cache line, so walking a price level touches one
+// line per order and nothing else. Everything else lives in OrderDetails,
+// found through `handle`; see OrderPool.
+struct alignas(64) RestingOrder {
+    uint64_t id;
+    Price price;              // Ticks (0 for market orders)
+    Quantity quantity;        // Total lots (as last amended)
+    Quantity filledQuantity;  // Lots filled so far
+
+    // Links in the FIFO queue of the price level the order rests at
+    RestingOrder* prev = nullptr;
+    RestingOrder* next = nullptr;
+
+    UserId userId;
+    uint32_t handle = 0;      // Pool slot, set by OrderPool
+
+    OrderSide side;
+    OrderType type;
+    TimeInForce timeInForce;
+    OrderStatus status = OrderStatus::PENDING;
+
+    RestingOrder(uint64_t id, UserId userId, OrderSide side, OrderType type,
+                 TimeInForce timeInForce, Price price, Quantity quantity)
+        : id(id), price(price), quantity(quantity), filledQuantity(0), userId(userId),
+          side(side), type(type), timeInForce(timeInForce) {}
+
+    Quantity getRemainingQuantity() const {
+        return quantity - filledQuantity;
+    }
+
+    bool isFilled() const {
+        return filledQuantity >= quantity;
+    }
+};
+
+static_assert(sizeof(RestingOrder) == 64, "RestingOrder must fill exactly one cache line");
+
+// Per-order fields the matching loop never reads: only touched when an
+// order starts or stops resting, is amended, or is copied out for a query
+struct OrderDetails {
+    std::chrono::system_clock::time_point timestamp;
+    Price stopPrice = 0;
+    int64_t expireTime = 0;   // GTD only, nanoseconds since the epoch
+
+    // Place in the book's expiry wheel (GTD only)
+    TimerLink<RestingOrder> expiry;
+
+    // Links in the book's list of open orders of the same user
+    RestingOrder* userPrev = nullptr;
+    RestingOrder* userNext = nullptr;
+};
+
+} // namespace DEX
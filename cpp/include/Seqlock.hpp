@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace DEX {
+
+// Single-writer sequence lock around a trivially copyable value.
+//
+// The writer bumps the sequence to an odd number, copies the value in and
+// bumps it to the next even number. Readers copy the value out and retry
+// if the sequence was odd or changed meanwhile, so they never block the
+// writer and always see a value that was published as a whole. The payload
+// is stored as relaxed atomic words, so the concurrent copy is race-free.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+    Seqlock() { store(T{}); }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Only one thread may store at a time
+    void store(const T& value) {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint64_t words[kWords];
+
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> words_[kWords];
+};
+
+} // namespace DEX
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "MpscQueue.hpp"
+#include "Order.hpp"
+#include "TradeSink.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DEX {
+
+using Hash256 = std::array<uint8_t, 32>;
+
+// One trade as committed to a settlement batch
+struct SettledTrade {
+    uint64_t sequence = 0;   // Assigned by Settlement::add, starts at 1
+    PairId pairId = 0;
+    Trade trade{};
+};
+
+// A closed batch of trades and the Keccak-256 Merkle tree over them.
+//
+// Leaf i is keccak256 of trades[i] packed big-endian into 52 bytes:
+// sequence (8), pairId (4), buyOrderId (8), sellOrderId (8), price in
+// ticks (8), quantity in lots (8), timestamp in nanoseconds since the
+// epoch (8). A parent is keccak256 of its two children, smaller one first,
+// and an unpaired last node moves up unchanged. That is the scheme
+// OpenZeppelin's MerkleProof verifies, and since leaves hash 52 bytes and
+// parents 64, a leaf can never pass for an inner node.
+struct SettlementBatch {
+    uint64_t sequence = 0;                  // Batch number, starts at 1
+    std::vector<SettledTrade> trades;
+    std::vector<std::vector<Hash256>> levels;  // Leaves first, root last
+
+    const Hash256& root() const { return levels.back().front(); }
+
+    // Sibling hashes from trades[index]'s leaf up to the root
+    std::vector<Hash256> proof(size_t index) const;
+
+    static Hash256 leafHash(const SettledTrade& trade);
+
+    // Does proof lead from leaf to root?
+    static bool verify(const Hash256& leaf, const std::vector<Hash256>& proof,
+                       const Hash256& root);
+};
+
+// Settlement pipeline stage: groups trades into batches and commits each
+// batch to one Merkle root, so the chain settles a root per batch rather
+// than a transaction per trade.
+//
+// add() only claims a sequence number and pushes the trade onto a
+// lock-free MPSC ring, like Journal::append. A background thread drains the
+// ring and closes a batch once its oldest trade is `interval` old or it
+// holds `maxTrades`, hashes the leaves and every tree level with
+// keccak256_batch (several messages per SIMD pass), and hands the batch to
+// the handler, all off the matching thread.
+class Settlement {
+public:
+    struct Options {
+        std::chrono::milliseconds interval{100};   // Longest a trade waits for its batch
+        size_t maxTrades = 4096;                    // Close a batch early at this size
+        size_t queueCapacity = 65536;               // Trades in flight, power of two
+    };
+
+    // Called on the settlement thread for every closed batch, in order.
+    // If it throws, the stage stops and flush() throws from then on.
+    using BatchHandler = std::function<void(const SettlementBatch&)>;
+
+    explicit Settlement(BatchHandler handler);
+    Settlement(BatchHandler handler, const Options& options);
+
+    // Closes and hands over one last batch with everything added
+    ~Settlement();
+
+    Settlement(const Settlement&) = delete;
+    Settlement& operator=(const Settlement&) = delete;
+
+    // Queue a trade for the next batch and return its sequence number.
+    // Blocks only while the ring is full. Never throws, since it runs in
+    // the middle of matching: once the stage has stopped it drops the
+    // trade and returns 0.
+    uint64_t add(PairId pairId, const Trade& trade) noexcept;
+
+    // Close the current batch now and block until every trade added before
+    // the call has been handed to the handler. Throws std::runtime_error if
+    // the handler has failed.
+    void flush();
+
+    // Has the handler failed? Trades added since then were dropped.
+    bool failed() const { return failed_.load(); }
+
+    // Sequence number of the last added trade (0 if none)
+    uint64_t lastSequence() const { return sequence_.load(); }
+
+    // Batches handed to the handler so far
+    uint64_t batchCount() const { return batches_.load(); }
+
+private:
+    BatchHandler handler_;
+    Options options_;
+
+    MpscQueue<SettledTrade> queue_;
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> added_{0};      // Trades pushed onto queue_
+    std::atomic<uint64_t> settled_{0};    // Trades handed to the handler
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<size_t> flushWaiters_{0};
+
+    std::thread worker_;
+    std::atomic<bool> running_{true};
+    std::atomic<bool> failed_{false};
+    std::atomic<size_t> producers_{0};    // Threads in the middle of add()
+
+    // Handler failure and flush() wakeups
+    std::mutex mutex_;
+    std::condition_variable settledSignal_;
+    std::string error_;
+
+    void run();
+    bool emit(std::vector<SettledTrade>& trades);
+};
+
+} // namespace DEX
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "MatchingEngine.hpp"
+#include "MpscQueue.hpp"
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace DEX {
+
+// Outcome of an order submitted through ShardedEngine: its ID and status
+// (see OrderBook::addOrder), so it can be cancelled later, and its fills
+struct SubmitResult {
+    OrderResult order;
+    std::vector<Trade> trades;
+};
+
+// Sharded execution mode for MatchingEngine.
+//
+// Every trading pair is owned by one shard, and each shard runs a single
+// matching thread (optionally pinned to a core) fed through a lock-free
+// MPSC queue. Submitting threads only resolve the pair to its shard and
+// enqueue, so pairs on different shards match in parallel and nothing
+// serializes on the engine lock. Results are delivered through a callback
+// on the shard thread, or through a future.
+//
+// Pairs must be added before start(); the routing table is read-only while
+// the shards run.
+class ShardedEngine {
+public:
+    struct Options {
+        size_t shardCount = 0;          // 0 = one per hardware thread
+        size_t queueCapacity = 65536;   // Per shard, power of two
+        bool pinThreads = true;         // Pin shard i to CPU i (Linux only)
+
+        // Memory for each pair's book. With pinThreads on a NUMA machine,
+        // a book without a numaNode gets the node of its shard's CPU.
+        BookMemory bookMemory;
+    };
+
+    // Called on the shard thread; error is set if the order failed validation
+    using SubmitCallback = std::function<void(SubmitResult result, std::exception_ptr error)>;
+    using CancelCallback = std::function<void(bool cancelled)>;
+
+    ShardedEngine();
+    explicit ShardedEngine(const Options& options);
+    ~ShardedEngine();
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    // Add a trading pair, owned by the least loaded shard or a chosen one
+    bool addTradingPair(const std::string& pair, const PairSpec& spec = PairSpec{});
+    bool addTradingPair(const std::string& pair, size_t shard, const PairSpec& spec = PairSpec{});
+
+    // See MatchingEngine::attachJournal; must be called before start()
+    void attachJournal(Journal* journal);
+
+    void start();
+    // Drains queued commands, then joins the shard threads
+    void stop();
+
+    // Enqueue an order; blocks only while the shard's queue is full
+    void submitOrder(const std::string& userId,
+                     const std::string& tradingPair,
+                     OrderSide side,
+                     OrderType type,
+                     double price,
+                     double quantity,
+                     SubmitCallback onComplete,
+                     TimeInForce timeInForce = TimeInForce::GTC);
+
+    std::future<SubmitResult> submitOrder(const std::string& userId,
+                                          const std::string& tradingPair,
+                                          OrderSide side,
+                                          OrderType type,
+                                          double price,
+                                          double quantity,
+                                          TimeInForce timeInForce = TimeInForce::GTC);
+
+    void cancelOrder(uint64_t orderId, const std::string& tradingPair, CancelCallback onComplete);
+    std::future<bool> cancelOrder(uint64_t orderId, const std::string& tradingPair);
+
+    // Read access (market data, user orders) goes through the wrapped engine
+    const MatchingEngine& engine() const { return engine_; }
+
+    size_t getShardCount() const { return shards_.size(); }
+
+    // Shards whose thread could not be pinned to its CPU (with pinThreads;
+    // always all of them off Linux), counted as each thread starts. They
+    // run unpinned.
+    size_t getUnpinnedShards() const { return unpinned_.load(); }
+
+private:
+    struct Command {
+        enum class Kind : uint8_t { SUBMIT, CANCEL };
+
+        Kind kind = Kind::SUBMIT;
+        OrderBook* book = nullptr;
+        UserId userId = 0;
+        OrderSide side = OrderSide::BUY;
+        OrderType type = OrderType::LIMIT;
+        TimeInForce timeInForce = TimeInForce::GTC;
+        double price = 0;
+        double quantity = 0;
+        uint64_t orderId = 0;
+
+        // Where the result goes: a callback, or the promise behind a future,
+        // held directly so a future costs no more than its shared state
+        std::variant<std::monostate, SubmitCallback, CancelCallback,
+                     std::promise<SubmitResult>, std::promise<bool>> reply;
+    };
+
+    struct Shard {
+        explicit Shard(size_t queueCapacity) : queue(queueCapacity) {}
+
+        MpscQueue<Command> queue;
+        std::thread thread;
+        size_t pairCount = 0;
+    };
+
+    struct Route {
+        OrderBook* book;
+        Shard* shard;
+    };
+
+    MatchingEngine engine_;
+    Options options_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unordered_map<std::string, Route> routes_;  // Immutable while running
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> producers_{0};  // Threads in the middle of enqueue()
+    std::atomic<size_t> unpinned_{0};
+
+    const Route& route(const std::string& tradingPair) const;
+    // Fill in command (its reply already set) and queue it on the pair's shard
+    void submit(const std::string& userId, const std::string& tradingPair, OrderSide side,
+                OrderType type, double price, double quantity, TimeInForce timeInForce,
+                Command&& command);
+    void cancel(uint64_t orderId, const std::string& tradingPair, Command&& command);
+    void enqueue(Shard& shard, Command&& command);
+    void run(Shard& shard, size_t index);
+    void execute(Command& command);
+};
+
+} // namespace DEX
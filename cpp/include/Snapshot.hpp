@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Order.hpp"
+#include "PairSpec.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DEX {
+
+class MatchingEngine;
+
+// On-disk snapshot format. Every section is an array of fixed-size records
+// at an 8 byte aligned offset from the start of the file, in host byte
+// order, so a loader can map the file and use the records in place.
+//
+//   SnapshotHeader
+//   SnapshotPair[pairCount]
+//   SnapshotUser[userCount]
+//   SnapshotOrder[] for each pair, bids best first then asks, each level
+//   in queue order, then untriggered buy stops and sell stops, each in
+//   trigger order
+//   Name bytes (pairs and users)
+struct SnapshotHeader {
+    static constexpr uint32_t kVersion = 4;
+
+    char magic[8];              // "DEXSNAP\0"
+    uint32_t version;
+    uint32_t pairCount;
+    uint64_t userCount;
+    uint64_t orderIdCounter;
+    uint64_t journalSequence;   // Journal position when the save started
+    uint64_t pairsOffset;
+    uint64_t usersOffset;
+    uint64_t fileSize;
+};
+
+struct SnapshotPair {
+    PairId pairId;
+    uint32_t nameLength;
+    uint64_t nameOffset;
+    double tickSize;
+    double lotSize;
+    uint64_t journalSequence;   // Last journal record reflected in this book
+    Price lastPrice;            // Last trade price, which stop orders trigger on
+    uint64_t ordersOffset;
+    uint64_t orderCount;
+};
+
+struct SnapshotUser {
+    uint64_t nameOffset;
+    uint64_t nameLength;
+};
+
+// One resting order, or a stop order waiting for its trigger
+struct SnapshotOrder {
+    uint64_t id;
+    UserId userId;
+    OrderSide side;
+    OrderType type;
+    TimeInForce timeInForce;
+    OrderStatus status;
+    Price price;
+    Quantity quantity;
+    Quantity filledQuantity;
+    int64_t timestamp;          // Nanoseconds since the epoch
+    Price stopPrice;            // Stop orders only
+    int64_t expireTime;         // Nanoseconds since the epoch, GTD only
+};
+
+// Everything saved for one book, copied out under the book lock
+struct BookImage {
+    std::string tradingPair;
+    PairId pairId = 0;
+    PairSpec spec;
+    uint64_t journalSequence = 0;
+    Price lastPrice = 0;
+    std::vector<SnapshotOrder> orders;
+};
+
+// Write a snapshot next to path and atomically rename it into place
+void writeSnapshot(const std::string& path, const SnapshotHeader& header,
+                   const std::vector<BookImage>& books, const std::vector<std::string>& users);
+
+// Read-only memory mapping of a snapshot file, validated on open
+class SnapshotFile {
+public:
+    // Throws std::runtime_error if the file is missing, truncated or not a snapshot
+    explicit SnapshotFile(const std::string& path);
+    ~SnapshotFile();
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    const SnapshotHeader& header() const { return *reinterpret_cast<const SnapshotHeader*>(data_); }
+
+    const SnapshotPair& pair(size_t index) const { return pairs()[index]; }
+    std::string pairName(size_t index) const;
+    const SnapshotOrder* orders(size_t index) const;
+
+    std::string userName(size_t index) const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+    const SnapshotPair* pairs() const {
+        return reinterpret_cast<const SnapshotPair*>(data_ + header().pairsOffset);
+    }
+    const SnapshotUser* users() const {
+        return reinterpret_cast<const SnapshotUser*>(data_ + header().usersOffset);
+    }
+
+    void validate(const std::string& path) const;
+};
+
+// Saves a snapshot of an engine at a fixed interval on a background thread
+class Snapshotter {
+public:
+    Snapshotter(const MatchingEngine& engine, const std::string& path,
+                std::chrono::milliseconds interval);
+    ~Snapshotter();
+
+    Snapshotter(const Snapshotter&) = delete;
+    Snapshotter& operator=(const Snapshotter&) = delete;
+
+    // Number of snapshots written so far
+    uint64_t getCount() const { return count_; }
+
+    // Message from the last save if it failed, empty otherwise
+    std::string getLastError() const;
+
+private:
+    const MatchingEngine& engine_;
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    std::atomic<uint64_t> count_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+    std::string lastError_;
+    std::thread thread_;
+
+    void run();
+};
+
+} // namespace DEX
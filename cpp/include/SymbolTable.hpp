@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace DEX {
+
+// Interns strings (user IDs) into dense integer IDs so that the hot path
+// carries a uint32_t instead of copying strings. IDs are never reused.
+class SymbolTable {
+public:
+    static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+    // Called for every newly assigned ID while the table is locked, so
+    // hooks see IDs in increasing order
+    using InsertHook = std::function<void(uint32_t id, const std::string& name)>;
+
+    // ID for a name, assigning a new one the first time it is seen
+    uint32_t intern(const std::string& name);
+
+    // ID for a name, or kInvalidId if it has never been interned
+    uint32_t find(const std::string& name) const;
+
+    // Name for an ID (must be a valid ID)
+    const std::string& name(uint32_t id) const;
+
+    size_t size() const;
+
+    void setInsertHook(InsertHook hook);
+
+private:
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::deque<std::string> names_;  // Stable references, indexed by ID
+    InsertHook onInsert_;
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace DEX
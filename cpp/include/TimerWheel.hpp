@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace DEX {
+
+// Where a node sits in a TimerWheel, embedded in the node's storage
+template <typename T>
+struct TimerLink {
+    static constexpr uint8_t kUnscheduled = 0xff;
+
+    T* prev = nullptr;
+    T* next = nullptr;
+    int64_t deadline = 0;            // Tick
+    uint8_t level = kUnscheduled;
+    uint8_t slot = 0;
+};
+
+// Hierarchical timing wheel of intrusive nodes, the structure behind book
+// order expiry.
+//
+// Time advances in ticks of kTickNanos. Level k has 64 slots, each
+// spanning 64^k ticks, and one occupancy bit per slot. A node goes on the
+// lowest level whose current 64-slot cycle contains its deadline, so the
+// slot follows from the deadline and bit arithmetic alone: scheduling and
+// cancelling are O(1). advance() jumps from one occupied slot to the next
+// by scanning the bitmaps, never tick by tick. Reaching a slot on level
+// k > 0 moves its nodes down a level; reaching a level 0 slot expires every
+// node in it in one batch. Eight levels cover 2^48 ticks, about 8,900
+// years of milliseconds, so absolute deadlines never overflow the wheel.
+//
+// LinkOf maps a node to its TimerLink.
+template <typename T, typename LinkOf>
+class TimerWheel {
+public:
+    static constexpr int64_t kTickNanos = 1000000;   // 1 ms
+    static constexpr int kLevels = 8;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+
+    explicit TimerWheel(LinkOf linkOf) : linkOf_(linkOf) {}
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Expire node at the first advance() to reach deadlineNanos (never
+    // before it, at most one tick after). A deadline already passed
+    // expires at the next advance().
+    void schedule(T* node, int64_t deadlineNanos) {
+        // Round up, so a node never expires early
+        int64_t tick = deadlineNanos <= 0 ? 0 : (deadlineNanos - 1) / kTickNanos + 1;
+        linkOf_(node).deadline = tick;
+        place(node);
+        ++size_;
+    }
+
+    // Take a node off the wheel; does nothing if it isn't scheduled
+    void cancel(T* node) {
+        TimerLink<T>& link = linkOf_(node);
+        if (link.level == TimerLink<T>::kUnscheduled) {
+            return;
+        }
+        unlink(link);
+        --size_;
+    }
+
+    // Move time forward to nowNanos and expire every node due by then,
+    // calling expire(node) on each after taking it off the wheel. Returns
+    // how many expired. Time never moves back. If expire throws, that node
+    // and every other one not yet expired stay scheduled.
+    template <typename F>
+    size_t advance(int64_t nowNanos, F&& expire) {
+        int64_t target = nowNanos / kTickNanos;
+        size_t expired = 0;
+
+        while (size_ != 0) {
+            int level;
+            int64_t start = nextEvent(level);
+            if (start > target) {
+                break;
+            }
+            now_ = start;
+
+            unsigned slot = slotOf(now_, level);
+            T* node = heads_[level][slot];
+            heads_[level][slot] = nullptr;
+            occupied_[level] &= ~(uint64_t(1) << slot);
+
+            while (node) {
+                TimerLink<T>& link = linkOf_(node);
+                T* next = link.next;
+                link.prev = link.next = nullptr;
+                link.level = TimerLink<T>::kUnscheduled;
+
+                if (level == 0) {
+                    --size_;
+                    ++expired;
+                    try {
+                        expire(node);
+                    } catch (...) {
+                        // Put this node and the rest of the slot back, due
+                        // at the next advance()
+                        ++size_;
+                        --expired;
+                        for (T* rest = node; rest; ) {
+                            T* after = rest == node ? next : linkOf_(rest).next;
+                            place(rest);
+                            rest = after;
+                        }
+                        throw;
+                    }
+                } else {
+                    // Within this slot's span, so it lands on a lower level
+                    place(node);
+                }
+                node = next;
+            }
+        }
+
+        if (target > now_) {
+            now_ = target;
+        }
+        return expired;
+    }
+
+private:
+    LinkOf linkOf_;
+    int64_t now_ = 0;   // Current tick
+    size_t size_ = 0;
+    uint64_t occupied_[kLevels] = {};
+    T* heads_[kLevels][kSlots] = {};
+
+    static unsigned slotOf(int64_t tick, int level) {
+        return static_cast<unsigned>(tick >> (kSlotBits * level)) & (kSlots - 1);
+    }
+
+    void place(T* node) {
+        TimerLink<T>& link = linkOf_(node);
+        int64_t tick = link.deadline < now_ ? now_ : link.deadline;
+
+        // Lowest level whose current cycle holds the deadline; the top
+        // level takes anything further out at its last slot
+        int level = 0;
+        while (level < kLevels - 1 &&
+               (tick >> (kSlotBits * (level + 1))) != (now_ >> (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        unsigned slot = slotOf(tick, level);
+        if (level == kLevels - 1 && (tick >> (kSlotBits * kLevels)) != (now_ >> (kSlotBits * kLevels))) {
+            slot = kSlots - 1;
+        }
+
+        link.level = static_cast<uint8_t>(level);
+        link.slot = static_cast<uint8_t>(slot);
+        link.prev = nullptr;
+        link.next = heads_[level][slot];
+        if (link.next) {
+            linkOf_(link.next).prev = node;
+        }
+        heads_[level][slot] = node;
+        occupied_[level] |= uint64_t(1) << slot;
+    }
+
+    void unlink(TimerLink<T>& link) {
+        if (link.prev) {
+            linkOf_(link.prev).next = link.next;
+        } else {
+            heads_[link.level][link.slot] = link.next;
+            if (!link.next) {
+                occupied_[link.level] &= ~(uint64_t(1) << link.slot);
+            }
+        }
+        if (link.next) {
+            linkOf_(link.next).prev = link.prev;
+        }
+        link.prev = link.next = nullptr;
+        link.level = TimerLink<T>::kUnscheduled;
+    }
+
+    // First tick at which an occupied slot is reached, and its level. Level
+    // 0 includes the current slot (deadlines already due); higher levels
+    // only hold slots after the current one.
+    int64_t nextEvent(int& level) const {
+        int64_t best = std::numeric_limits<int64_t>::max();
+        level = -1;
+
+        for (int k = 0; k < kLevels; ++k) {
+            unsigned current = slotOf(now_, k);
+            uint64_t bits = k == 0 ? occupied_[k] & (~uint64_t(0) << current)
+                          : current == kSlots - 1 ? 0
+                          : occupied_[k] & (~uint64_t(0) << (current + 1));
+            if (!bits) {
+                continue;
+            }
+
+            int shift = kSlotBits * (k + 1);
+            int64_t cycle = k + 1 < kLevels ? (now_ >> shift) << shift : 0;
+            int64_t start = cycle | (static_cast<int64_t>(__builtin_ctzll(bits)) << (kSlotBits * k));
+            if (start < best) {
+                best = start;
+                level = k;
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace DEX
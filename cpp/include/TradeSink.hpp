@@ -0,0 +1,44 @@
+#pragma once
+
+#include "PairSpec.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace DEX {
+
+struct Trade {
+    uint64_t buyOrderId;
+    uint64_t sellOrderId;
+    Price price;        // Ticks
+    Quantity quantity;  // Lots
+    std::chrono::system_clock::time_point timestamp;
+};
+
+// Non-owning reference to a callable invoked inline for every fill.
+//
+// Costs one indirect call per trade and never allocates, so matching can
+// write straight into a ring buffer or any other consumer. The callable
+// must outlive the call it is passed to.
+class TradeSink {
+public:
+    template <typename F,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<F>, TradeSink>::value &&
+                  std::is_invocable<std::remove_reference_t<F>&, const Trade&>::value>>
+    TradeSink(F&& callable)
+        : context_(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+          invoke_([](void* context, const Trade& trade) {
+              (*static_cast<std::remove_reference_t<F>*>(context))(trade);
+          }) {}
+
+    void operator()(const Trade& trade) const { invoke_(context_, trade); }
+
+private:
+    void* context_;
+    void (*invoke_)(void*, const Trade&);
+};
+
+} // namespace DEX
@@ -0,0 +1,244 @@
+#include "../include/BookArena.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+namespace DEX {
+
+namespace {
+
+constexpr size_t kPageBytes = 4096;
+
+size_t roundUp(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+// Prefer pages from node for the whole range (not bind: when the node runs
+// out the kernel falls back to others rather than failing the fault)
+void preferNode(void* memory, size_t bytes, int node) {
+#ifdef __linux__
+    std::vector<unsigned long> mask(static_cast<size_t>(node) / (8 * sizeof(unsigned long)) + 1, 0);
+    mask[static_cast<size_t>(node) / (8 * sizeof(unsigned long))] |=
+        1ul << (static_cast<size_t>(node) % (8 * sizeof(unsigned long)));
+
+    // Best effort: a kernel without NUMA support has nowhere else to put them
+    syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED, mask.data(),
+            mask.size() * 8 * sizeof(unsigned long) + 1, 0);
+#else
+    (void)memory;
+    (void)bytes;
+    (void)node;
+#endif
+}
+
+} // namespace
+
+BookArena::BookArena(const Options& options)
+    : options_(options),
+      mapped_(options.hugePages || options.numaNode >= 0 || options.prefault) {
+    validate(options);
+}
+
+BookArena::~BookArena() {
+    for (const Mapping& mapping : regions_) {
+        unmap(mapping);
+    }
+    for (const Mapping& mapping : large_) {
+        unmap(mapping);
+    }
+}
+
+void BookArena::validate(const Options& options) {
+    if (options.numaNode >= nodeCount()) {
+        throw std::invalid_argument("No NUMA node " + std::to_string(options.numaNode));
+    }
+}
+
+void* BookArena::allocate(size_t bytes, size_t alignment) {
+    if (!mapped_) {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    if (bytes > kRegionBytes / 2) {
+        size_t size = roundUp(bytes, kRegionBytes);
+        char* memory = map(size);
+        large_.push_back(Mapping{memory, size});
+        return memory;
+    }
+
+    unsigned sizeClass = BookArena::sizeClass(bytes);
+    size_t classBytes = size_t(1) << (sizeClass + kMinClassBits);
+
+    // Blocks are carved aligned to their size up to a page, so a freed one
+    // suits nearly any later request of its class
+    FreeBlock* block = free_[sizeClass];
+    if (block && reinterpret_cast<uintptr_t>(block) % alignment == 0) {
+        free_[sizeClass] = block->next;
+        return block;
+    }
+    return carve(classBytes, std::max(alignment, std::min(classBytes, kPageBytes)));
+}
+
+void BookArena::deallocate(void* memory, size_t bytes, size_t alignment) {
+    if (!mapped_) {
+        ::operator delete(memory, std::align_val_t(alignment));
+        return;
+    }
+
+    if (bytes > kRegionBytes / 2) {
+        auto it = std::find_if(large_.begin(), large_.end(),
+                               [memory](const Mapping& mapping) { return mapping.memory == memory; });
+        if (it != large_.end()) {
+            unmap(*it);
+            large_.erase(it);
+        }
+        return;
+    }
+
+    unsigned sizeClass = BookArena::sizeClass(bytes);
+    FreeBlock* block = static_cast<FreeBlock*>(memory);
+    block->next = free_[sizeClass];
+    free_[sizeClass] = block;
+}
+
+unsigned BookArena::sizeClass(size_t bytes) {
+    size_t classBytes = size_t(1) << kMinClassBits;
+    unsigned sizeClass = 0;
+    while (classBytes < bytes) {
+        classBytes <<= 1;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+char* BookArena::carve(size_t bytes, size_t alignment) {
+    char* memory = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(cursor_), alignment));
+    if (!cursor_ || memory + bytes > end_) {
+        // The rest of the current region is left unused
+        char* region = map(kRegionBytes);
+        regions_.push_back(Mapping{region, kRegionBytes});
+        memory = region;
+        end_ = region + kRegionBytes;
+    }
+    cursor_ = memory + bytes;
+    return memory;
+}
+
+char* BookArena::map(size_t bytes) {
+    void* memory = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    // Reserved huge pages, if the administrator set any aside
+    if (options_.hugePages) {
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
+    if (memory == MAP_FAILED) {
+        // Over-map, then trim to a 2 MB boundary so transparent huge pages
+        // can back the whole range
+        size_t padded = bytes + kRegionBytes;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        char* start = static_cast<char*>(raw);
+        char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(start), kRegionBytes));
+        if (aligned != start) {
+            munmap(start, static_cast<size_t>(aligned - start));
+        }
+        char* tail = aligned + bytes;
+        if (tail != start + padded) {
+            munmap(tail, static_cast<size_t>(start + padded - tail));
+        }
+        memory = aligned;
+
+#ifdef MADV_HUGEPAGE
+        if (options_.hugePages) {
+            madvise(memory, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    // Placement has to be set before the first touch
+    if (options_.numaNode >= 0) {
+        preferNode(memory, bytes, options_.numaNode);
+    }
+
+    char* pages = static_cast<char*>(memory);
+    if (options_.prefault) {
+        for (size_t offset = 0; offset < bytes; offset += kPageBytes) {
+            *static_cast<volatile char*>(pages + offset) = 0;
+        }
+    }
+
+    mappedBytes_ += bytes;
+    return pages;
+}
+
+void BookArena::unmap(const Mapping& mapping) {
+    munmap(mapping.memory, mapping.bytes);
+    mappedBytes_ -= mapping.bytes;
+}
+
+int BookArena::nodeCount() {
+#ifdef __linux__
+    // A list like "0" or "0-1,4-5"; nodes are numbered up to its last entry
+    FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+    if (!file) {
+        return 1;
+    }
+
+    int last = 0;
+    int id;
+    while (std::fscanf(file, "%d", &id) == 1) {
+        last = std::max(last, id);
+        if (std::fgetc(file) == EOF) {
+            break;
+        }
+    }
+    std::fclose(file);
+    return last + 1;
+#else
+    return 1;
+#endif
+}
+
+int BookArena::nodeOfCpu(size_t cpu) {
+#ifdef __linux__
+    // The CPU's sysfs directory has a nodeN link to its node
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return -1;
+    }
+
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        int id;
+        if (std::sscanf(entry->d_name, "node%d", &id) == 1) {
+            node = id;
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+} // namespace DEX
@@ -0,0 +1,85 @@
+#include "../include/EngineStats.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace DEX {
+
+namespace {
+
+thread_local uint64_t allocations = 0;
+
+} // namespace
+
+uint64_t threadAllocations() {
+    return allocations;
+}
+
+} // namespace DEX
+
+#ifdef DEX_ENABLE_STATS
+
+// Counting replacements for the global allocation functions. Linked in
+// because OrderBook calls threadAllocations(). The aligned forms (used by
+// ArenaAllocator and BookArena without a mapping) are replaced too: the
+// standard library's call aligned_alloc directly rather than operator
+// new. Its nothrow forms forward to these.
+void* operator new(std::size_t size) {
+    ++DEX::allocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    ++DEX::allocations;
+    // aligned_alloc wants a size that is a multiple of the alignment
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t bytes = size ? (size + align - 1) / align * align : align;
+    if (void* memory = std::aligned_alloc(align, bytes)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+#endif
@@ -0,0 +1,347 @@
+#include "../include/Journal.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace DEX {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'E', 'X', 'J', 'R', 'N', 'L', '\0'};
+constexpr uint32_t kFormatVersion = 3;
+constexpr size_t kHeaderSize = 16;
+constexpr size_t kFrameSize = 8;             // Payload length + checksum
+constexpr uint32_t kMaxPayload = 1 << 16;    // Longest name is well below this
+
+// Spins before the idle writer starts sleeping between polls
+constexpr unsigned kIdleSpins = 4096;
+constexpr auto kIdleSleep = std::chrono::microseconds(50);
+
+uint32_t checksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void put(std::vector<char>& out, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Bounds-checked reads from a record payload
+class Cursor {
+public:
+    Cursor(const char* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - offset_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string& value, size_t length) {
+        if (size_ - offset_ < length) return false;
+        value.assign(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+    bool done() const { return offset_ == size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+bool hasName(JournalRecord::Type type) {
+    return type == JournalRecord::Type::PAIR || type == JournalRecord::Type::USER;
+}
+
+// Append one framed record to out
+void encode(const JournalRecord& record, std::vector<char>& out) {
+    size_t frame = out.size();
+    out.resize(frame + kFrameSize);
+
+    put(out, record.sequence);
+    put(out, static_cast<uint8_t>(record.type));
+    put(out, static_cast<uint8_t>(record.side));
+    put(out, static_cast<uint8_t>(record.orderType));
+    put(out, static_cast<uint8_t>(record.timeInForce));
+    put(out, record.pairId);
+    put(out, record.userId);
+    put(out, record.orderId);
+    put(out, record.price);
+    put(out, record.quantity);
+
+    if (record.type == JournalRecord::Type::SUBMIT) {
+        put(out, record.stopPrice);
+        put(out, record.expireTime);
+    }
+    if (record.type == JournalRecord::Type::PAIR) {
+        put(out, record.spec.tickSize);
+        put(out, record.spec.lotSize);
+    }
+    if (hasName(record.type)) {
+        put(out, static_cast<uint32_t>(record.name.size()));
+        out.insert(out.end(), record.name.begin(), record.name.end());
+    }
+
+    uint32_t length = static_cast<uint32_t>(out.size() - frame - kFrameSize);
+    uint32_t sum = checksum(out.data() + frame + kFrameSize, length);
+    std::memcpy(out.data() + frame, &length, sizeof(length));
+    std::memcpy(out.data() + frame + sizeof(length), &sum, sizeof(sum));
+}
+
+bool decode(const char* data, size_t size, JournalRecord& record) {
+    Cursor cursor(data, size);
+    uint8_t type, side, orderType, timeInForce;
+
+    if (!cursor.get(record.sequence) || !cursor.get(type) || !cursor.get(side) ||
+        !cursor.get(orderType) || !cursor.get(timeInForce) || !cursor.get(record.pairId) ||
+        !cursor.get(record.userId) || !cursor.get(record.orderId) ||
+        !cursor.get(record.price) || !cursor.get(record.quantity)) {
+        return false;
+    }
+
+    if (type < static_cast<uint8_t>(JournalRecord::Type::PAIR) ||
+        type > static_cast<uint8_t>(JournalRecord::Type::EXPIRE)) {
+        return false;
+    }
+
+    record.type = static_cast<JournalRecord::Type>(type);
+    record.side = static_cast<OrderSide>(side);
+    record.orderType = static_cast<OrderType>(orderType);
+    record.timeInForce = static_cast<TimeInForce>(timeInForce);
+    record.stopPrice = 0;
+    record.expireTime = 0;
+    record.spec = PairSpec{};
+    record.name.clear();
+
+    if (record.type == JournalRecord::Type::SUBMIT &&
+        (!cursor.get(record.stopPrice) || !cursor.get(record.expireTime))) {
+        return false;
+    }
+
+    if (record.type == JournalRecord::Type::PAIR &&
+        (!cursor.get(record.spec.tickSize) || !cursor.get(record.spec.lotSize))) {
+        return false;
+    }
+    if (hasName(record.type)) {
+        uint32_t length;
+        if (!cursor.get(length) || !cursor.get(record.name, length)) {
+            return false;
+        }
+    }
+
+    return cursor.done();
+}
+
+} // namespace
+
+Journal::Journal(const std::string& path) : Journal(path, Options{}) {}
+
+Journal::Journal(const std::string& path, const Options& options)
+    : path_(path), options_(options), queue_(options.queueCapacity) {
+    // Pick up where an existing journal left off, dropping a torn tail
+    uint64_t validBytes = 0;
+    {
+        std::ifstream probe(path, std::ios::binary | std::ios::ate);
+        if (probe && probe.tellg() > 0) {
+            JournalReader reader(path);
+            JournalRecord record;
+            while (reader.next(record)) {
+                sequence_ = record.sequence;
+            }
+            validBytes = reader.validBytes();
+        }
+    }
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open journal " + path + ": " + std::strerror(errno));
+    }
+
+    if (validBytes == 0) {
+        std::vector<char> header(kMagic, kMagic + sizeof(kMagic));
+        put(header, kFormatVersion);
+        put(header, uint32_t{0});
+
+        if (::ftruncate(fd_, 0) != 0 || !commit(header)) {
+            ::close(fd_);
+            throw std::runtime_error("Cannot initialize journal " + path);
+        }
+    } else if (::ftruncate(fd_, static_cast<off_t>(validBytes)) != 0 ||
+               ::lseek(fd_, 0, SEEK_END) < 0) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot open journal " + path + ": " + std::strerror(errno));
+    }
+
+    writer_ = std::thread([this] { run(); });
+}
+
+Journal::~Journal() {
+    running_ = false;
+    writer_.join();
+    ::close(fd_);
+}
+
+uint64_t Journal::append(JournalRecord&& record) {
+    // Same shutdown handshake as ShardedEngine::enqueue
+    producers_.fetch_add(1);
+
+    if (!running_ || failed_) {
+        producers_.fetch_sub(1);
+        throw std::runtime_error("Journal is not writable: " + path_);
+    }
+
+    uint64_t sequence = ++sequence_;
+    record.sequence = sequence;
+
+    while (!queue_.tryPush(std::move(record))) {
+        if (failed_) {
+            producers_.fetch_sub(1);
+            throw std::runtime_error("Journal is not writable: " + path_);
+        }
+        std::this_thread::yield();
+    }
+
+    ++appended_;
+    producers_.fetch_sub(1);
+    return sequence;
+}
+
+void Journal::flush() {
+    uint64_t target = appended_.load();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    committed_.wait(lock, [&] { return written_.load() >= target || !error_.empty(); });
+
+    if (!error_.empty()) {
+        throw std::runtime_error("Journal write failed: " + error_);
+    }
+}
+
+void Journal::run() {
+    std::vector<char> buffer;
+    JournalRecord record;
+    unsigned idle = 0;
+
+    for (;;) {
+        // Once no producer can push any more, one last drain and we are done
+        bool stopping = !running_ && producers_.load() == 0;
+
+        uint64_t batch = 0;
+        buffer.clear();
+        while (buffer.size() < options_.maxBatchBytes && queue_.tryPop(record)) {
+            encode(record, buffer);
+            ++batch;
+        }
+
+        if (batch > 0) {
+            if (!commit(buffer)) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                written_ += batch;
+            }
+            committed_.notify_all();
+            idle = 0;
+            continue;
+        }
+
+        if (stopping) {
+            return;
+        }
+
+        if (++idle < kIdleSpins) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+}
+
+bool Journal::commit(const std::vector<char>& buffer) {
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+
+    while (remaining > 0) {
+        ssize_t written = ::write(fd_, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+
+    if (remaining == 0 && (!options_.sync || ::fdatasync(fd_) == 0)) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::strerror(errno);
+    }
+    failed_ = true;
+    committed_.notify_all();
+    return false;
+}
+
+JournalReader::JournalReader(const std::string& path) : in_(path, std::ios::binary) {
+    if (!in_) {
+        throw std::runtime_error("Cannot open journal " + path);
+    }
+
+    char header[kHeaderSize];
+    uint32_t version = 0;
+    if (!in_.read(header, kHeaderSize) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a journal file: " + path);
+    }
+
+    std::memcpy(&version, header + sizeof(kMagic), sizeof(version));
+    if (version != kFormatVersion) {
+        throw std::runtime_error("Unsupported journal version in " + path);
+    }
+
+    validBytes_ = kHeaderSize;
+}
+
+bool JournalReader::next(JournalRecord& record) {
+    char frame[kFrameSize];
+    if (!in_ || !in_.read(frame, kFrameSize)) {
+        return false;
+    }
+
+    uint32_t length, sum;
+    std::memcpy(&length, frame, sizeof(length));
+    std::memcpy(&sum, frame + sizeof(length), sizeof(sum));
+
+    if (length <= kMaxPayload) {
+        payload_.resize(length);
+        if (in_.read(payload_.data(), length) &&
+            checksum(payload_.data(), length) == sum &&
+            decode(payload_.data(), length, record)) {
+            validBytes_ += kFrameSize + length;
+            return true;
+        }
+    }
+
+    // Torn or corrupt; stop here
+    in_.setstate(std::ios::failbit);
+    return false;
+}
+
+} // namespace DEX
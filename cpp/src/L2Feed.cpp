@@ -0,0 +1,98 @@
+#include "../include/L2Feed.hpp"
+#include <new>
+#include <stdexcept>
+
+namespace DEX {
+
+void L2Feed::validate(const Options& options) {
+    if (options.capacity < 2 || (options.capacity & (options.capacity - 1)) != 0) {
+        throw std::invalid_argument("L2 feed capacity must be a power of two");
+    }
+    // A subscriber resyncing from the latest snapshot must still find the
+    // updates that followed it in the ring
+    if (options.snapshotInterval == 0 || options.snapshotInterval > options.capacity / 4) {
+        throw std::invalid_argument("L2 feed snapshot interval must be between 1 and capacity / 4");
+    }
+}
+
+L2Feed::L2Feed(const Options& options, BookArena* arena)
+    : options_(options), mask_(options.capacity - 1), allocator_(arena) {
+    validate(options);
+    slots_ = allocator_.allocate(options.capacity);
+    for (size_t i = 0; i < options.capacity; ++i) {
+        new (&slots_[i]) Slot();
+    }
+
+    std::atomic_store(&snapshot_, std::shared_ptr<const L2Snapshot>(std::make_shared<L2Snapshot>()));
+}
+
+L2Feed::~L2Feed() {
+    // Slots hold only atomics of trivial types, nothing to destroy
+    allocator_.deallocate(slots_, mask_ + 1);
+}
+
+void L2Feed::publishSnapshot(std::shared_ptr<const L2Snapshot> snapshot) {
+    snapshotSequence_ = snapshot->sequence;
+    std::atomic_store(&snapshot_, std::move(snapshot));
+}
+
+std::shared_ptr<const L2Snapshot> L2Feed::latestSnapshot() const {
+    return std::atomic_load(&snapshot_);
+}
+
+bool L2Feed::read(uint64_t sequence, L2Update& out) const {
+    const Slot& slot = slots_[sequence & mask_];
+
+    uint64_t stamp = slot.stamp.load(std::memory_order_acquire);
+    if (stamp != 2 * sequence) {
+        return false;
+    }
+
+    Price price = slot.price.load(std::memory_order_relaxed);
+    Quantity quantity = slot.quantity.load(std::memory_order_relaxed);
+    uint64_t countAndSide = slot.countAndSide.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.stamp.load(std::memory_order_relaxed) != stamp) {
+        return false;
+    }
+
+    out.sequence = sequence;
+    out.side = static_cast<OrderSide>(countAndSide & 0xff);
+    out.price = price;
+    out.quantity = quantity;
+    out.orderCount = static_cast<uint32_t>(countAndSide >> 8);
+    return true;
+}
+
+L2Subscriber::L2Subscriber(const L2Feed& feed) : feed_(feed) {
+    resync();
+}
+
+size_t L2Subscriber::poll(L2Update* out, size_t maxUpdates) {
+    if (lagged_) {
+        return 0;
+    }
+
+    uint64_t last = feed_.lastSequence();
+    size_t count = 0;
+
+    while (count < maxUpdates && next_ <= last) {
+        if (!feed_.read(next_, out[count])) {
+            lagged_ = true;
+            return 0;
+        }
+        ++next_;
+        ++count;
+    }
+    return count;
+}
+
+const L2Snapshot& L2Subscriber::resync() {
+    snapshot_ = feed_.latestSnapshot();
+    next_ = snapshot_->sequence + 1;
+    lagged_ = false;
+    return *snapshot_;
+}
+
+} // namespace DEX
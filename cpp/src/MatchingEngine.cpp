@@ -1,19 +1,92 @@
 #include "../include/MatchingEngine.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 namespace DEX {
 
+namespace {
+
+JournalRecord pairRecord(const OrderBook& orderBook) {
+    JournalRecord record;
+    record.type = JournalRecord::Type::PAIR;
+    record.pairId = orderBook.getPairId();
+    record.spec = orderBook.getSpec();
+    record.name = orderBook.getTradingPair();
+    return record;
+}
+
+JournalRecord userRecord(UserId userId, const std::string& name) {
+    JournalRecord record;
+    record.type = JournalRecord::Type::USER;
+    record.userId = userId;
+    record.name = name;
+    return record;
+}
+
+} // namespace
+
 MatchingEngine::MatchingEngine() : orderIdCounter_(0) {}
 
-bool MatchingEngine::addTradingPair(const std::string& pair) {
-    std::lock_guard<std::mutex> lock(mutex_);
+PairId MatchingEngine::addTradingPair(const std::string& pair, const PairSpec& spec) {
+    BookMemory memory;
+    {
+        CountingLock lock(mutex_, lockStats_);
+        memory = bookMemory_;
+    }
+    return addTradingPair(pair, spec, memory);
+}
+
+PairId MatchingEngine::addTradingPair(const std::string& pair, const PairSpec& spec,
+                                      const BookMemory& memory) {
+    if (!spec.isValid()) {
+        throw std::invalid_argument("Tick size and lot size must be positive");
+    }
+
+    CountingLock lock(mutex_, lockStats_);
 
     if (orderBooks_.find(pair) != orderBooks_.end()) {
-        return false; // Already exists
+        return kInvalidPairId; // Already exists
+    }
+
+    PairId pairId = pairCount_.load(std::memory_order_relaxed);
+    if (pairId >= kMaxTradingPairs) {
+        throw std::length_error("Too many trading pairs");
+    }
+
+    auto orderBook = std::make_shared<OrderBook>(pair, spec, pairId, memory);
+    if (recentOrderCapacity_ != OrderBook::kDefaultRecentOrders) {
+        orderBook->setRecentOrderCapacity(recentOrderCapacity_);
     }
 
-    orderBooks_[pair] = std::make_shared<OrderBook>(pair);
-    return true;
+    if (journal_) {
+        journal_->append(pairRecord(*orderBook));
+        orderBook->setJournal(journal_);
+    }
+    if (settlement_) {
+        orderBook->setSettlement(settlement_);
+    }
+    if (l2FeedEnabled_) {
+        orderBook->enableL2Feed(l2FeedOptions_);
+    }
+
+    orderBooks_[pair] = orderBook;
+
+    // Fill the slot, then publish it to lock-free readers
+    auto& page = pairPages_[pairId / kPairPageSize];
+    if (!page) {
+        page.reset(new OrderBook*[kPairPageSize]());
+    }
+    page[pairId % kPairPageSize] = orderBook.get();
+    pairCount_.store(pairId + 1, std::memory_order_release);
+
+    return pairId;
+}
+
+PairId MatchingEngine::getPairId(const std::string& tradingPair) const {
+    CountingLock lock(mutex_, lockStats_);
+
+    auto it = orderBooks_.find(tradingPair);
+    return it == orderBooks_.end() ? kInvalidPairId : it->second->getPairId();
 }
 
 std::vector<Trade> MatchingEngine::submitOrder(const std::string& userId,
@@ -21,26 +94,295 @@ std::vector<Trade> MatchingEngine::submitOrder(const std::string& userId,
                                                OrderSide side,
                                                OrderType type,
                                                double price,
-                                               double quantity) {
+                                               double quantity,
+                                               TimeInForce timeInForce,
+                                               std::chrono::system_clock::time_point expireTime) {
+    std::vector<Trade> trades;
+    submitOrder(userId, tradingPair, side, type, price, quantity,
+                [&trades](const Trade& trade) { trades.push_back(trade); }, timeInForce,
+                expireTime);
+    return trades;
+}
+
+OrderResult MatchingEngine::submitOrder(const std::string& userId,
+                                        const std::string& tradingPair,
+                                        OrderSide side,
+                                        OrderType type,
+                                        double price,
+                                        double quantity,
+                                        TradeSink sink,
+                                        TimeInForce timeInForce,
+                                        std::chrono::system_clock::time_point expireTime) {
+    std::shared_ptr<OrderBook> orderBook;
+    UserId user;
+    {
+        StageTimer<SharedStageStats> timer(lookupStats_);
+
+        orderBook = getOrderBook(tradingPair);
+        if (!orderBook) {
+            throw std::runtime_error("Trading pair not found: " + tradingPair);
+        }
+        user = users_.intern(userId);
+    }
+
+    return submitOrder(*orderBook, user, side, type, price, quantity, sink, timeInForce, expireTime);
+}
+
+std::vector<Trade> MatchingEngine::submitOrder(OrderBook& orderBook,
+                                               UserId userId,
+                                               OrderSide side,
+                                               OrderType type,
+                                               double price,
+                                               double quantity,
+                                               TimeInForce timeInForce,
+                                               std::chrono::system_clock::time_point expireTime) {
+    std::vector<Trade> trades;
+    submitOrder(orderBook, userId, side, type, price, quantity,
+                [&trades](const Trade& trade) { trades.push_back(trade); }, timeInForce,
+                expireTime);
+    return trades;
+}
+
+OrderResult MatchingEngine::submitOrder(OrderBook& orderBook,
+                                        UserId userId,
+                                        OrderSide side,
+                                        OrderType type,
+                                        double price,
+                                        double quantity,
+                                        TradeSink sink,
+                                        TimeInForce timeInForce,
+                                        std::chrono::system_clock::time_point expireTime) {
+    NewOrder order;
+    {
+        StageTimer<SharedStageStats> timer(prepareStats_);
+        order = prepareOrder(orderBook, userId, side, type, price, quantity, timeInForce,
+                             0, expireTime);
+    }
+    order.orderId = generateOrderId();
+
+    return OrderResult{order.orderId, orderBook.addOrder(order, sink)};
+}
+
+std::vector<Trade> MatchingEngine::submitOrder(PairId pairId,
+                                               UserId userId,
+                                               OrderSide side,
+                                               OrderType type,
+                                               double price,
+                                               double quantity,
+                                               TimeInForce timeInForce,
+                                               std::chrono::system_clock::time_point expireTime) {
+    std::vector<Trade> trades;
+    submitOrder(pairId, userId, side, type, price, quantity,
+                [&trades](const Trade& trade) { trades.push_back(trade); }, timeInForce,
+                expireTime);
+    return trades;
+}
+
+OrderResult MatchingEngine::submitOrder(PairId pairId,
+                                        UserId userId,
+                                        OrderSide side,
+                                        OrderType type,
+                                        double price,
+                                        double quantity,
+                                        TradeSink sink,
+                                        TimeInForce timeInForce,
+                                        std::chrono::system_clock::time_point expireTime) {
+    OrderBook* orderBook = getOrderBook(pairId);
+    if (!orderBook) {
+        throw std::runtime_error("Trading pair not found: " + std::to_string(pairId));
+    }
+
+    return submitOrder(*orderBook, userId, side, type, price, quantity, sink, timeInForce, expireTime);
+}
+
+std::vector<Trade> MatchingEngine::submitStopOrder(const std::string& userId,
+                                                   const std::string& tradingPair,
+                                                   OrderSide side,
+                                                   OrderType type,
+                                                   double stopPrice,
+                                                   double price,
+                                                   double quantity,
+                                                   TimeInForce timeInForce,
+                                                   std::chrono::system_clock::time_point expireTime) {
+    std::vector<Trade> trades;
+    submitStopOrder(userId, tradingPair, side, type, stopPrice, price, quantity,
+                    [&trades](const Trade& trade) { trades.push_back(trade); }, timeInForce,
+                expireTime);
+    return trades;
+}
+
+OrderResult MatchingEngine::submitStopOrder(const std::string& userId,
+                                            const std::string& tradingPair,
+                                            OrderSide side,
+                                            OrderType type,
+                                            double stopPrice,
+                                            double price,
+                                            double quantity,
+                                            TradeSink sink,
+                                            TimeInForce timeInForce,
+                                            std::chrono::system_clock::time_point expireTime) {
+    PairId pairId = getPairId(tradingPair);
+    if (pairId == kInvalidPairId) {
+        throw std::runtime_error("Trading pair not found: " + tradingPair);
+    }
+
+    return submitStopOrder(pairId, users_.intern(userId), side, type, stopPrice, price, quantity,
+                           sink, timeInForce, expireTime);
+}
+
+OrderResult MatchingEngine::submitStopOrder(PairId pairId,
+                                            UserId userId,
+                                            OrderSide side,
+                                            OrderType type,
+                                            double stopPrice,
+                                            double price,
+                                            double quantity,
+                                            TradeSink sink,
+                                            TimeInForce timeInForce,
+                                            std::chrono::system_clock::time_point expireTime) {
+    OrderBook* orderBook = getOrderBook(pairId);
+    if (!orderBook) {
+        throw std::runtime_error("Trading pair not found: " + std::to_string(pairId));
+    }
+    if (!isStop(type)) {
+        throw std::invalid_argument("Stop orders must be STOP or STOP_LIMIT");
+    }
+
+    NewOrder order = prepareOrder(*orderBook, userId, side, type, price, quantity,
+                                  timeInForce, stopPrice, expireTime);
+    order.orderId = generateOrderId();
+
+    return OrderResult{order.orderId, orderBook->addOrder(order, sink)};
+}
+
+size_t MatchingEngine::submitOrders(const OrderRequest* requests, size_t count,
+                                    std::vector<Trade>& trades) {
+    size_t before = trades.size();
+    submitOrders(requests, count, [&trades](const Trade& trade) { trades.push_back(trade); });
+    return trades.size() - before;
+}
+
+void MatchingEngine::submitOrders(const OrderRequest* requests, size_t count, TradeSink sink) {
+    struct Pending {
+        OrderBook* book;
+        NewOrder order;
+    };
+
+    std::vector<Pending> pending;
+    pending.reserve(count);
+
+    // Resolve every pair under one engine lock; bursts tend to repeat the
+    // same pair, so remember the last lookup
+    std::vector<std::shared_ptr<OrderBook>> books;
+    {
+        CountingLock lock(mutex_, lockStats_);
+        const std::string* lastPair = nullptr;
+
+        for (size_t i = 0; i < count; ++i) {
+            const std::string& pair = requests[i].tradingPair;
+            if (!lastPair || *lastPair != pair) {
+                auto it = orderBooks_.find(pair);
+                if (it == orderBooks_.end()) {
+                    throw std::runtime_error("Trading pair not found: " + pair);
+                }
+                books.push_back(it->second);
+                lastPair = &pair;
+            }
+            pending.push_back(Pending{books.back().get(), NewOrder{}});
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const OrderRequest& request = requests[i];
+        pending[i].order = prepareOrder(*pending[i].book, 0, request.side, request.type,
+                                        request.price, request.quantity,
+                                        request.timeInForce, request.stopPrice,
+                                        request.expireTime);
+    }
+
+    // Only a batch that passed validation interns (and journals) its users
+    for (size_t i = 0; i < count; ++i) {
+        pending[i].order.userId = users_.intern(requests[i].userId);
+    }
+
+    // IDs follow arrival order across the whole batch
+    for (auto& entry : pending) {
+        entry.order.orderId = generateOrderId();
+    }
+
+    std::stable_sort(pending.begin(), pending.end(),
+        [](const Pending& a, const Pending& b) { return a.book < b.book; });
+
+    std::vector<NewOrder> group;
+    group.reserve(count);
+
+    for (size_t start = 0; start < pending.size();) {
+        OrderBook* book = pending[start].book;
+
+        group.clear();
+        size_t end = start;
+        for (; end < pending.size() && pending[end].book == book; ++end) {
+            group.push_back(pending[end].order);
+        }
+
+        book->addOrders(group.data(), group.size(), sink);
+        start = end;
+    }
+}
+
+NewOrder MatchingEngine::prepareOrder(const OrderBook& orderBook, UserId userId, OrderSide side,
+                                      OrderType type, double price, double quantity,
+                                      TimeInForce timeInForce, double stopPrice,
+                                      std::chrono::system_clock::time_point expireTime) {
     if (quantity <= 0) {
         throw std::invalid_argument("Quantity must be positive");
     }
 
-    if (type == OrderType::LIMIT && price <= 0) {
+    // Market and stop-market orders take whatever price the book offers
+    const bool priced = type != OrderType::MARKET && type != OrderType::STOP;
+
+    if (priced && price <= 0) {
         throw std::invalid_argument("Price must be positive for limit orders");
     }
 
-    auto orderBook = getOrderBook(tradingPair);
-    if (!orderBook) {
-        throw std::runtime_error("Trading pair not found: " + tradingPair);
+    const PairSpec& spec = orderBook.getSpec();
+    Price ticks = spec.toTicks(price);
+    Quantity lots = spec.toLots(quantity);
+
+    if (lots <= 0) {
+        throw std::invalid_argument("Quantity must be at least one lot");
+    }
+
+    if (priced && ticks <= 0) {
+        throw std::invalid_argument("Price must be at least one tick for limit orders");
     }
 
-    uint64_t orderId = generateOrderId();
-    auto order = std::make_shared<Order>(
-        orderId, userId, tradingPair, side, type, price, quantity
-    );
+    Price stopTicks = 0;
+    if (isStop(type)) {
+        if (stopPrice <= 0 || (stopTicks = spec.toTicks(stopPrice)) <= 0) {
+            throw std::invalid_argument("Stop orders need a stop price of at least one tick");
+        }
+    } else if (stopPrice != 0) {
+        throw std::invalid_argument("Only stop orders take a stop price");
+    }
+
+    if (type == OrderType::POST_ONLY && timeInForce != TimeInForce::GTC &&
+        timeInForce != TimeInForce::GTD) {
+        throw std::invalid_argument("Post-only orders must rest: GTC or GTD");
+    }
 
-    return orderBook->addOrder(order);
+    int64_t expireNanos = 0;
+    if (timeInForce == TimeInForce::GTD) {
+        if (expireTime <= std::chrono::system_clock::now()) {
+            throw std::invalid_argument("GTD orders need an expiry time in the future");
+        }
+        expireNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            expireTime.time_since_epoch()).count();
+    } else if (expireTime != std::chrono::system_clock::time_point{}) {
+        throw std::invalid_argument("Only GTD orders take an expiry time");
+    }
+
+    return NewOrder{0, userId, side, type, ticks, lots, timeInForce, stopTicks, expireNanos};
 }
 
 bool MatchingEngine::cancelOrder(uint64_t orderId, const std::string& tradingPair) {
@@ -52,8 +394,290 @@ bool MatchingEngine::cancelOrder(uint64_t orderId, const std::string& tradingPai
     return orderBook->cancelOrder(orderId);
 }
 
+bool MatchingEngine::cancelOrder(uint64_t orderId, PairId pairId) {
+    OrderBook* orderBook = getOrderBook(pairId);
+    return orderBook && orderBook->cancelOrder(orderId);
+}
+
+size_t MatchingEngine::expireOrders(std::chrono::system_clock::time_point now) {
+    size_t expired = 0;
+    for (PairId pairId = 0; pairId < getTradingPairCount(); ++pairId) {
+        expired += getOrderBook(pairId)->expireOrders(now);
+    }
+    return expired;
+}
+
+bool MatchingEngine::amendOrder(uint64_t orderId, const std::string& tradingPair,
+                                double newPrice, double newQuantity,
+                                std::vector<Trade>& trades) {
+    return amendOrder(orderId, tradingPair, newPrice, newQuantity,
+                      [&trades](const Trade& trade) { trades.push_back(trade); });
+}
+
+bool MatchingEngine::getOrder(uint64_t orderId, const std::string& tradingPair, Order& order) const {
+    PairId pairId = getPairId(tradingPair);
+    return pairId != kInvalidPairId && getOrder(orderId, pairId, order);
+}
+
+bool MatchingEngine::getOrder(uint64_t orderId, PairId pairId, Order& order) const {
+    const OrderBook* orderBook = getOrderBook(pairId);
+    return orderBook && orderBook->getOrder(orderId, order);
+}
+
+void MatchingEngine::setRecentOrderCapacity(size_t capacity) {
+    CountingLock lock(mutex_, lockStats_);
+
+    recentOrderCapacity_ = capacity;
+    for (auto& [pair, orderBook] : orderBooks_) {
+        orderBook->setRecentOrderCapacity(capacity);
+    }
+}
+
+bool MatchingEngine::amendOrder(uint64_t orderId, const std::string& tradingPair,
+                                double newPrice, double newQuantity, TradeSink sink) {
+    PairId pairId = getPairId(tradingPair);
+    return pairId != kInvalidPairId && amendOrder(orderId, pairId, newPrice, newQuantity, sink);
+}
+
+bool MatchingEngine::amendOrder(uint64_t orderId, PairId pairId,
+                                double newPrice, double newQuantity,
+                                std::vector<Trade>& trades) {
+    return amendOrder(orderId, pairId, newPrice, newQuantity,
+                      [&trades](const Trade& trade) { trades.push_back(trade); });
+}
+
+bool MatchingEngine::amendOrder(uint64_t orderId, PairId pairId,
+                                double newPrice, double newQuantity, TradeSink sink) {
+    OrderBook* orderBook = getOrderBook(pairId);
+    if (!orderBook) {
+        return false;
+    }
+
+    // Same grid and range checks as a new limit order
+    NewOrder amended = prepareOrder(*orderBook, 0, OrderSide::BUY, OrderType::LIMIT,
+                                    newPrice, newQuantity, TimeInForce::GTC);
+
+    return orderBook->amendOrder(orderId, amended.price, amended.quantity, sink);
+}
+
+EngineStats MatchingEngine::getStats() const {
+    EngineStats stats;
+    stats.totalOrders = getTotalOrders();
+    stats.tradingPairCount = getTradingPairCount();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.engineLock = lockStats_;
+    }
+    stats.lookup = lookupStats_.load();
+    stats.prepare = prepareStats_.load();
+
+    for (PairId pairId = 0; pairId < stats.tradingPairCount; ++pairId) {
+        stats.books += getOrderBook(pairId)->getStats();
+    }
+    return stats;
+}
+
+std::vector<std::string> MatchingEngine::getTradingPairs() const {
+    std::vector<std::string> pairs(pairCount_.load(std::memory_order_acquire));
+    for (PairId pairId = 0; pairId < pairs.size(); ++pairId) {
+        pairs[pairId] = getOrderBook(pairId)->getTradingPair();
+    }
+    return pairs;
+}
+
+void MatchingEngine::attachJournal(Journal* journal) {
+    CountingLock lock(mutex_, lockStats_);
+
+    if (journal && journal->lastSequence() == 0) {
+        for (PairId pairId = 0; pairId < pairCount_; ++pairId) {
+            journal->append(pairRecord(*getOrderBook(pairId)));
+        }
+        for (size_t id = 0; id < users_.size(); ++id) {
+            journal->append(userRecord(static_cast<UserId>(id), users_.name(static_cast<UserId>(id))));
+        }
+    }
+
+    journal_ = journal;
+    for (auto& [pair, orderBook] : orderBooks_) {
+        orderBook->setJournal(journal);
+    }
+
+    if (journal) {
+        users_.setInsertHook([journal](uint32_t id, const std::string& name) {
+            journal->append(userRecord(id, name));
+        });
+    } else {
+        users_.setInsertHook(nullptr);
+    }
+}
+
+void MatchingEngine::attachSettlement(Settlement* settlement) {
+    CountingLock lock(mutex_, lockStats_);
+
+    settlement_ = settlement;
+    for (auto& [pair, orderBook] : orderBooks_) {
+        orderBook->setSettlement(settlement);
+    }
+}
+
+uint64_t MatchingEngine::replayJournal(const std::string& path) {
+    {
+        CountingLock lock(mutex_, lockStats_);
+
+        if (journal_) {
+            throw std::logic_error("Replay the journal before attaching one");
+        }
+    }
+
+    // Journal position each book already reflects, e.g. from a snapshot
+    std::vector<uint64_t> applied(getTradingPairCount());
+    for (PairId pairId = 0; pairId < applied.size(); ++pairId) {
+        applied[pairId] = getOrderBook(pairId)->getJournalSequence();
+    }
+
+    auto bookFor = [this](PairId pairId) -> OrderBook& {
+        OrderBook* orderBook = getOrderBook(pairId);
+        if (!orderBook) {
+            throw std::runtime_error("Journal references an unknown trading pair");
+        }
+        return *orderBook;
+    };
+
+    // Replayed fills were already reported when the orders first executed
+    auto ignoreTrades = [](const Trade&) {};
+
+    JournalReader reader(path);
+    JournalRecord record;
+    uint64_t lastSequence = 0;
+
+    while (reader.next(record)) {
+        lastSequence = std::max(lastSequence, record.sequence);
+
+        switch (record.type) {
+        case JournalRecord::Type::PAIR: {
+            if (const OrderBook* known = getOrderBook(record.pairId)) {
+                if (known->getTradingPair() != record.name) {
+                    throw std::runtime_error("Journal pair IDs don't match this engine");
+                }
+                break;
+            }
+            if (addTradingPair(record.name, record.spec) != record.pairId) {
+                throw std::runtime_error("Journal pair IDs don't match this engine");
+            }
+            applied.resize(getTradingPairCount());
+            break;
+        }
+
+        case JournalRecord::Type::USER: {
+            bool known = record.userId < users_.size();
+            if ((known ? users_.name(record.userId) != record.name
+                       : users_.intern(record.name) != record.userId)) {
+                throw std::runtime_error("Journal user IDs don't match this engine");
+            }
+            break;
+        }
+
+        case JournalRecord::Type::SUBMIT:
+        case JournalRecord::Type::CANCEL:
+        case JournalRecord::Type::AMEND:
+        case JournalRecord::Type::EXPIRE: {
+            OrderBook& orderBook = bookFor(record.pairId);
+            if (record.sequence <= applied[record.pairId]) {
+                break;
+            }
+            applied[record.pairId] = record.sequence;
+
+            if (record.type == JournalRecord::Type::SUBMIT) {
+                orderBook.addOrder(
+                    NewOrder{record.orderId, record.userId, record.side, record.orderType,
+                             record.price, record.quantity, record.timeInForce,
+                             record.stopPrice, record.expireTime},
+                    ignoreTrades);
+                if (record.orderId > orderIdCounter_) {
+                    orderIdCounter_ = record.orderId;
+                }
+            } else if (record.type == JournalRecord::Type::CANCEL) {
+                orderBook.cancelOrder(record.orderId);
+            } else if (record.type == JournalRecord::Type::EXPIRE) {
+                orderBook.expireOrder(record.orderId);
+            } else {
+                orderBook.amendOrder(record.orderId, record.price, record.quantity, ignoreTrades);
+            }
+            break;
+        }
+        }
+    }
+
+    for (PairId pairId = 0; pairId < applied.size(); ++pairId) {
+        getOrderBook(pairId)->markJournaled(applied[pairId]);
+    }
+
+    return lastSequence;
+}
+
+void MatchingEngine::saveSnapshot(const std::string& path) const {
+    SnapshotHeader header{};
+    {
+        CountingLock lock(mutex_, lockStats_);
+        header.journalSequence = journal_ ? journal_->lastSequence() : 0;
+    }
+
+    std::vector<BookImage> images(getTradingPairCount());
+    for (PairId pairId = 0; pairId < images.size(); ++pairId) {
+        getOrderBook(pairId)->exportImage(images[pairId]);
+    }
+
+    // Read after the books, so every order ID and user they refer to is covered
+    header.orderIdCounter = orderIdCounter_;
+
+    std::vector<std::string> users(users_.size());
+    for (size_t i = 0; i < users.size(); ++i) {
+        users[i] = users_.name(static_cast<UserId>(i));
+    }
+
+    writeSnapshot(path, header, images, users);
+}
+
+uint64_t MatchingEngine::loadSnapshot(const std::string& path) {
+    SnapshotFile file(path);
+    const SnapshotHeader& header = file.header();
+
+    {
+        CountingLock lock(mutex_, lockStats_);
+        if (journal_ || !orderBooks_.empty() || users_.size() != 0) {
+            throw std::logic_error("Snapshots can only be loaded into an empty engine");
+        }
+    }
+
+    for (uint64_t i = 0; i < header.userCount; ++i) {
+        if (users_.intern(file.userName(i)) != i) {
+            throw std::runtime_error("Corrupt snapshot file: " + path);
+        }
+    }
+
+    for (size_t i = 0; i < header.pairCount; ++i) {
+        const SnapshotPair& entry = file.pair(i);
+        std::string pair = file.pairName(i);
+
+        PairSpec spec;
+        spec.tickSize = entry.tickSize;
+        spec.lotSize = entry.lotSize;
+
+        if (addTradingPair(pair, spec) != entry.pairId) {
+            throw std::runtime_error("Corrupt snapshot file: " + path);
+        }
+
+        getOrderBook(entry.pairId)->restoreImage(file.orders(i), entry.orderCount,
+                                                 entry.journalSequence, entry.lastPrice);
+    }
+
+    orderIdCounter_ = header.orderIdCounter;
+    return header.journalSequence;
+}
+
 std::shared_ptr<OrderBook> MatchingEngine::getOrderBook(const std::string& tradingPair) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    CountingLock lock(mutex_, lockStats_);
 
     auto it = orderBooks_.find(tradingPair);
     if (it == orderBooks_.end()) {
@@ -64,37 +688,135 @@ std::shared_ptr<OrderBook> MatchingEngine::getOrderBook(const std::string& tradi
 }
 
 MatchingEngine::MarketData MatchingEngine::getMarketData(const std::string& tradingPair) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    auto it = orderBooks_.find(tradingPair);
-    if (it == orderBooks_.end()) {
+    PairId pairId = getPairId(tradingPair);
+    if (pairId == kInvalidPairId) {
         throw std::runtime_error("Trading pair not found: " + tradingPair);
     }
 
-    auto& orderBook = it->second;
+    return getMarketData(pairId);
+}
+
+MatchingEngine::MarketData MatchingEngine::getMarketData(PairId pairId) const {
+    const OrderBook* orderBook = getOrderBook(pairId);
+    if (!orderBook) {
+        throw std::runtime_error("Trading pair not found: " + std::to_string(pairId));
+    }
+
+    // A single snapshot keeps best prices, spread and depth consistent
+    const PairSpec& spec = orderBook->getSpec();
+    BookSnapshot snapshot = orderBook->getSnapshot();
 
     MarketData data;
-    data.bestBid = orderBook->getBestBid();
-    data.bestAsk = orderBook->getBestAsk();
-    data.spread = (data.bestAsk > 0 && data.bestBid > 0)
-        ? (data.bestAsk - data.bestBid)
+    data.bestBid = spec.toPrice(snapshot.bestBid);
+    data.bestAsk = spec.toPrice(snapshot.bestAsk);
+    data.spread = (snapshot.bestAsk > 0 && snapshot.bestBid > 0)
+        ? spec.toPrice(snapshot.bestAsk - snapshot.bestBid)
         : 0.0;
-    data.bidDepth = orderBook->getBidDepth(10);
-    data.askDepth = orderBook->getAskDepth(10);
+
+    for (uint32_t i = 0; i < snapshot.bidLevels; ++i) {
+        data.bidDepth[spec.toPrice(snapshot.bids[i].price)] = spec.toQuantity(snapshot.bids[i].quantity);
+    }
+    for (uint32_t i = 0; i < snapshot.askLevels; ++i) {
+        data.askDepth[spec.toPrice(snapshot.asks[i].price)] = spec.toQuantity(snapshot.asks[i].quantity);
+    }
 
     return data;
 }
 
-std::vector<OrderPtr> MatchingEngine::getUserOrders(const std::string& userId,
-                                                    const std::string& tradingPair) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+BookSnapshot MatchingEngine::getMarketSnapshot(const std::string& tradingPair) const {
+    PairId pairId = getPairId(tradingPair);
+    if (pairId == kInvalidPairId) {
+        throw std::runtime_error("Trading pair not found: " + tradingPair);
+    }
+
+    return getMarketSnapshot(pairId);
+}
+
+BookSnapshot MatchingEngine::getMarketSnapshot(PairId pairId) const {
+    const OrderBook* orderBook = getOrderBook(pairId);
+    if (!orderBook) {
+        throw std::runtime_error("Trading pair not found: " + std::to_string(pairId));
+    }
+
+    return orderBook->getSnapshot();
+}
+
+void MatchingEngine::setBookMemory(const BookMemory& memory) {
+    BookArena::validate(memory.arena);
+
+    CountingLock lock(mutex_, lockStats_);
+    bookMemory_ = memory;
+}
+
+void MatchingEngine::enableL2Feed(const L2Feed::Options& options) {
+    CountingLock lock(mutex_, lockStats_);
+
+    // Check the options once, before any book takes them
+    L2Feed::validate(options);
+
+    l2FeedEnabled_ = true;
+    l2FeedOptions_ = options;
+    for (auto& [pair, orderBook] : orderBooks_) {
+        orderBook->enableL2Feed(options);
+    }
+}
+
+const L2Feed* MatchingEngine::getL2Feed(const std::string& tradingPair) const {
+    PairId pairId = getPairId(tradingPair);
+    if (pairId == kInvalidPairId) {
+        throw std::runtime_error("Trading pair not found: " + tradingPair);
+    }
+
+    return getL2Feed(pairId);
+}
+
+const L2Feed* MatchingEngine::getL2Feed(PairId pairId) const {
+    const OrderBook* orderBook = getOrderBook(pairId);
+    if (!orderBook) {
+        throw std::runtime_error("Trading pair not found: " + std::to_string(pairId));
+    }
+
+    return orderBook->getL2Feed();
+}
+
+std::vector<Order> MatchingEngine::getUserOrders(const std::string& userId,
+                                                 const std::string& tradingPair) const {
+    UserId user = users_.find(userId);
+    if (user == SymbolTable::kInvalidId) {
+        return {};
+    }
+
+    CountingLock lock(mutex_, lockStats_);
 
     auto it = orderBooks_.find(tradingPair);
     if (it == orderBooks_.end()) {
         return {};
     }
 
-    return it->second->getUserOrders(userId);
+    return it->second->getUserOrders(user);
+}
+
+std::vector<Order> MatchingEngine::getUserOrders(UserId userId, PairId pairId) const {
+    const OrderBook* orderBook = getOrderBook(pairId);
+    return orderBook ? orderBook->getUserOrders(userId) : std::vector<Order>{};
+}
+
+std::vector<Order> MatchingEngine::getUserOrders(const std::string& userId) const {
+    std::vector<Order> orders;
+
+    UserId user = users_.find(userId);
+    if (user == SymbolTable::kInvalidId) {
+        return orders;
+    }
+
+    // Walk the pair table without the engine lock; each book is queried
+    // under its own lock only
+    PairId pairCount = getTradingPairCount();
+    for (PairId pairId = 0; pairId < pairCount; ++pairId) {
+        getOrderBook(pairId)->appendUserOrders(user, orders);
+    }
+
+    return orders;
 }
 
 } // namespace DEX
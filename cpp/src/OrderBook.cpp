@@ -4,289 +4,931 @@
 
 namespace DEX {
 
-OrderBook::OrderBook(const std::string& tradingPair)
-    : tradingPair_(tradingPair) {}
+namespace {
 
-std::vector<Trade> OrderBook::addOrder(OrderPtr order) {
-    std::lock_guard<std::mutex> lock(mutex_);
+std::chrono::system_clock::time_point fromNanos(int64_t nanos) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(nanos)));
+}
 
-    if (order->tradingPair != tradingPair_) {
-        throw std::invalid_argument("Order trading pair doesn't match orderbook");
-    }
+int64_t toNanos(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
 
-    orders_[order->id] = order;
+// Fill out with up to maxLevels levels of a side, best first
+template <typename Ladder>
+size_t collectDepth(const Ladder& ladder, DepthLevel* out, size_t maxLevels) {
+    size_t count = 0;
+    ladder.forEach([&](const PriceLevel& level) {
+        if (count >= maxLevels) return false;
+
+        out[count++] = DepthLevel{level.price, level.totalQuantity, level.orderCount};
+        return true;
+    });
+    return count;
+}
 
-    // Try to match the order
-    auto trades = matchOrder(order);
+} // namespace
 
-    // If order is not fully filled, add to the book
-    if (!order->isFilled()) {
-        if (order->side == OrderSide::BUY) {
-            bids_[order->price].push_back(order);
-        } else {
-            asks_[order->price].push_back(order);
-        }
+OrderBook::OrderBook(const std::string& tradingPair, const PairSpec& spec, PairId pairId,
+                     const BookMemory& memory)
+    : tradingPair_(tradingPair), spec_(spec), pairId_(pairId), arena_(memory.arena) {
+    // Set up (and with prefault, fault in) the working set before trading
+    if (memory.reserveOrders) {
+        pool_.reserve(memory.reserveOrders);
+        orders_.reserve(memory.reserveOrders);
     }
+}
 
+std::vector<Trade> OrderBook::addOrder(uint64_t orderId, UserId userId, OrderSide side,
+                                       OrderType type, Price price, Quantity quantity) {
+    std::vector<Trade> trades;
+    addOrder(NewOrder{orderId, userId, side, type, price, quantity},
+             [&trades](const Trade& trade) { trades.push_back(trade); });
     return trades;
 }
 
-std::vector<Trade> OrderBook::matchOrder(OrderPtr newOrder) {
-    std::vector<Trade> trades;
+OrderStatus OrderBook::addOrder(const NewOrder& order, TradeSink sink) {
+    CountingLock lock(mutex_, stats_.lock);
+    AllocationCounter allocations(stats_.allocations);
+
+    OrderStatus status = insertOrder(order, sink);
+
+    publishSnapshot();
+
+    return status;
+}
+
+size_t OrderBook::addOrders(const NewOrder* orders, size_t count, std::vector<Trade>& trades) {
+    size_t before = trades.size();
+    addOrders(orders, count, [&trades](const Trade& trade) { trades.push_back(trade); });
+    return trades.size() - before;
+}
+
+void OrderBook::addOrders(const NewOrder* orders, size_t count, TradeSink sink) {
+    CountingLock lock(mutex_, stats_.lock);
+    AllocationCounter allocations(stats_.allocations);
 
-    if (newOrder->type == OrderType::MARKET) {
-        // Market orders match at any price
-        if (newOrder->side == OrderSide::BUY) {
-            // Buy order matches against asks
-            while (!newOrder->isFilled() && !asks_.empty()) {
-                auto& [price, orders] = *asks_.begin();
-
-                while (!newOrder->isFilled() && !orders.empty()) {
-                    auto oppositeOrder = orders.front();
-
-                    double matchPrice = oppositeOrder->price;
-                    double matchQuantity = std::min(
-                        newOrder->getRemainingQuantity(),
-                        oppositeOrder->getRemainingQuantity()
-                    );
-
-                    auto trade = executeTrade(newOrder, oppositeOrder, matchPrice, matchQuantity);
-                    trades.push_back(trade);
-
-                    if (oppositeOrder->isFilled()) {
-                        orders.erase(orders.begin());
-                    }
-                }
-
-                if (orders.empty()) {
-                    asks_.erase(asks_.begin());
-                }
+    for (size_t i = 0; i < count; ++i) {
+        insertOrder(orders[i], sink);
+    }
+
+    publishSnapshot();
+}
+
+OrderStatus OrderBook::insertOrder(const NewOrder& request, TradeSink sink) {
+    if (orders_.contains(request.orderId)) {
+        throw std::invalid_argument("Duplicate order ID");
+    }
+
+    // Logged before it executes; replay repeats the same decisions below
+    journalOrder(request);
+
+    const bool buy = request.side == OrderSide::BUY;
+
+    // Post-only and fill-or-kill are decided up front from the best price
+    // and level aggregates, so a rejected order never touches the book
+    if (request.type == OrderType::POST_ONLY) {
+        if (buy ? wouldCross<OrderSide::BUY>(request.price)
+                : wouldCross<OrderSide::SELL>(request.price)) {
+            recordRejected(request, OrderStatus::REJECTED);
+            return OrderStatus::REJECTED;
+        }
+    } else if (request.timeInForce == TimeInForce::FOK && !isStop(request.type)) {
+        // A stop order is checked when it triggers instead
+        if (!canFillNow(request.side, request.type, request.price, request.quantity)) {
+            recordRejected(request, OrderStatus::CANCELLED);
+            return OrderStatus::CANCELLED;
+        }
+    }
+
+    // One clock read per incoming order, shared by the order and its fills
+    auto now = std::chrono::system_clock::now();
+
+    RestingOrder* order = pool_.allocate(request.orderId, request.userId, request.side,
+                                         request.type, request.timeInForce, request.price,
+                                         request.quantity);
+    pool_.details(order).timestamp = now;
+    orders_.insert(order->id, order);
+    if constexpr (kStatsEnabled) ++stats_.orders;
+
+    // On the wheel from the start; retireOrder takes it off again if the
+    // order never rests
+    if (order->timeInForce == TimeInForce::GTD) {
+        pool_.details(order).expireTime = request.expireTime;
+        expiries_.schedule(order, request.expireTime);
+    }
+
+    OrderStatus status;
+    if (isStop(order->type)) {
+        pool_.details(order).stopPrice = request.stopPrice;
+        if (!stopReached(order->side, request.stopPrice)) {
+            // Nothing traded, so nothing else can have triggered
+            if (buy) {
+                addStop<OrderSide::BUY>(order);
+            } else {
+                addStop<OrderSide::SELL>(order);
             }
+            return OrderStatus::PENDING;
+        }
+        status = fireStop(order, sink);
+    } else {
+        status = executeOrder(order, sink, now);
+    }
+
+    triggerStops(sink);
+    return status;
+}
+
+OrderStatus OrderBook::executeOrder(RestingOrder* order, TradeSink sink,
+                                    std::chrono::system_clock::time_point now) {
+    // Try to match the order (post-only orders are known not to cross)
+    if (order->type != OrderType::POST_ONLY) {
+        StageTimer<> timer(stats_.match);
+        matchOrder(*order, sink, now);
+    }
+
+    if (order->isFilled()) {
+        retireOrder(order, OrderStatus::FILLED);
+        return OrderStatus::FILLED;
+    }
+
+    // Market orders, IOC and FOK never rest; drop what didn't fill
+    if (order->type == OrderType::MARKET || order->timeInForce == TimeInForce::IOC ||
+        order->timeInForce == TimeInForce::FOK) {
+        retireOrder(order, OrderStatus::CANCELLED);
+        return OrderStatus::CANCELLED;
+    }
+
+    // Rest the remainder in the book
+    StageTimer<> timer(stats_.rest);
+    if (order->side == OrderSide::BUY) {
+        rest<OrderSide::BUY>(order);
+    } else {
+        rest<OrderSide::SELL>(order);
+    }
+
+    return order->status;
+}
+
+bool OrderBook::canFillNow(OrderSide side, OrderType type, Price price, Quantity quantity) {
+    const bool buy = side == OrderSide::BUY;
+    return type == OrderType::MARKET
+        ? (buy ? canFill<OrderSide::BUY, OrderType::MARKET>(price, quantity)
+               : canFill<OrderSide::SELL, OrderType::MARKET>(price, quantity))
+        : (buy ? canFill<OrderSide::BUY, OrderType::LIMIT>(price, quantity)
+               : canFill<OrderSide::SELL, OrderType::LIMIT>(price, quantity));
+}
+
+OrderStatus OrderBook::fireStop(RestingOrder* order, TradeSink sink) {
+    order->type = order->type == OrderType::STOP ? OrderType::MARKET : OrderType::LIMIT;
+
+    auto now = std::chrono::system_clock::now();
+    pool_.details(order).timestamp = now;
+
+    if (order->timeInForce == TimeInForce::FOK &&
+        !canFillNow(order->side, order->type, order->price, order->quantity)) {
+        retireOrder(order, OrderStatus::CANCELLED);
+        return OrderStatus::CANCELLED;
+    }
+
+    return executeOrder(order, sink, now);
+}
+
+void OrderBook::triggerStops(TradeSink sink) {
+    // Each pass removes one stop order and none are added, so this ends
+    for (;;) {
+        RestingOrder* order;
+        if (!buyStops_.empty() && stopReached(OrderSide::BUY, buyStops_.bestPrice())) {
+            order = buyStops_.best()->head;
+            removeStop<OrderSide::BUY>(order);
+        } else if (!sellStops_.empty() && stopReached(OrderSide::SELL, sellStops_.bestPrice())) {
+            order = sellStops_.best()->head;
+            removeStop<OrderSide::SELL>(order);
         } else {
-            // Sell order matches against bids
-            while (!newOrder->isFilled() && !bids_.empty()) {
-                auto& [price, orders] = *bids_.begin();
-
-                while (!newOrder->isFilled() && !orders.empty()) {
-                    auto oppositeOrder = orders.front();
-
-                    double matchPrice = oppositeOrder->price;
-                    double matchQuantity = std::min(
-                        newOrder->getRemainingQuantity(),
-                        oppositeOrder->getRemainingQuantity()
-                    );
-
-                    auto trade = executeTrade(oppositeOrder, newOrder, matchPrice, matchQuantity);
-                    trades.push_back(trade);
-
-                    if (oppositeOrder->isFilled()) {
-                        orders.erase(orders.begin());
-                    }
-                }
-
-                if (orders.empty()) {
-                    bids_.erase(bids_.begin());
-                }
-            }
+            return;
+        }
+
+        unlinkUserOrder(order);
+        fireStop(order, sink);
+    }
+}
+
+void OrderBook::matchOrder(RestingOrder& newOrder, TradeSink sink,
+                           std::chrono::system_clock::time_point now) {
+    // One specialized kernel per side/type, selected once per order
+    if (newOrder.side == OrderSide::BUY) {
+        if (newOrder.type == OrderType::MARKET) {
+            match<OrderSide::BUY, OrderType::MARKET>(newOrder, sink, now);
+        } else {
+            match<OrderSide::BUY, OrderType::LIMIT>(newOrder, sink, now);
         }
     } else {
-        // Limit orders match only at acceptable prices
-        if (newOrder->side == OrderSide::BUY) {
-            // Buy order matches against asks
-            while (!newOrder->isFilled() && !asks_.empty()) {
-                auto& [price, orders] = *asks_.begin();
-
-                // Check if price is acceptable
-                if (price > newOrder->price) {
-                    break;
-                }
-
-                while (!newOrder->isFilled() && !orders.empty()) {
-                    auto oppositeOrder = orders.front();
-
-                    double matchPrice = oppositeOrder->price;
-                    double matchQuantity = std::min(
-                        newOrder->getRemainingQuantity(),
-                        oppositeOrder->getRemainingQuantity()
-                    );
-
-                    auto trade = executeTrade(newOrder, oppositeOrder, matchPrice, matchQuantity);
-                    trades.push_back(trade);
-
-                    if (oppositeOrder->isFilled()) {
-                        orders.erase(orders.begin());
-                    }
-                }
-
-                if (orders.empty()) {
-                    asks_.erase(asks_.begin());
-                }
-            }
+        if (newOrder.type == OrderType::MARKET) {
+            match<OrderSide::SELL, OrderType::MARKET>(newOrder, sink, now);
         } else {
-            // Sell order matches against bids
-            while (!newOrder->isFilled() && !bids_.empty()) {
-                auto& [price, orders] = *bids_.begin();
-
-                // Check if price is acceptable
-                if (price < newOrder->price) {
-                    break;
-                }
-
-                while (!newOrder->isFilled() && !orders.empty()) {
-                    auto oppositeOrder = orders.front();
-
-                    double matchPrice = oppositeOrder->price;
-                    double matchQuantity = std::min(
-                        newOrder->getRemainingQuantity(),
-                        oppositeOrder->getRemainingQuantity()
-                    );
-
-                    auto trade = executeTrade(oppositeOrder, newOrder, matchPrice, matchQuantity);
-                    trades.push_back(trade);
-
-                    if (oppositeOrder->isFilled()) {
-                        orders.erase(orders.begin());
-                    }
-                }
-
-                if (orders.empty()) {
-                    bids_.erase(bids_.begin());
-                }
+            match<OrderSide::SELL, OrderType::LIMIT>(newOrder, sink, now);
+        }
+    }
+}
+
+template <OrderSide S, OrderType T>
+void OrderBook::match(RestingOrder& newOrder, TradeSink sink,
+                      std::chrono::system_clock::time_point now) {
+    constexpr OrderSide Opposite = S == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+    auto& book = ladder<Opposite>();
+
+    while (!newOrder.isFilled() && !book.empty()) {
+        PriceLevel& level = *book.best();
+        if constexpr (kStatsEnabled) ++stats_.levelsTouched;
+
+        // Limit orders stop at the first level better than their own price
+        // from the resting side's point of view; market orders never stop
+        if (T == OrderType::LIMIT && book.isBetter(newOrder.price, level.price)) {
+            break;
+        }
+
+        while (!newOrder.isFilled() && !level.empty()) {
+            RestingOrder& oppositeOrder = *level.head;
+            // The next order in the queue is likely needed if this one fills
+            if (oppositeOrder.next) {
+                __builtin_prefetch(oppositeOrder.next);
+            }
+
+            Quantity matchQuantity = std::min(
+                newOrder.getRemainingQuantity(),
+                oppositeOrder.getRemainingQuantity()
+            );
+
+            Trade trade = S == OrderSide::BUY
+                ? executeTrade(newOrder, oppositeOrder, level.price, matchQuantity, now)
+                : executeTrade(oppositeOrder, newOrder, level.price, matchQuantity, now);
+            level.reduce(matchQuantity);
+            sink(trade);
+            if (settlement_) {
+                settlement_->add(pairId_, trade);
+            }
+            if constexpr (kStatsEnabled) ++stats_.trades;
+
+            if (oppositeOrder.isFilled()) {
+                level.popFront();
+                unlinkUserOrder(&oppositeOrder);
+                retireOrder(&oppositeOrder, OrderStatus::FILLED);
             }
         }
+
+        // One update per level, however many of its orders filled
+        lastPrice_ = level.price;
+        publishLevel(Opposite, level);
+        if (level.empty()) {
+            book.erase(level.price);
+        }
     }
+}
 
-    return trades;
+template <OrderSide S>
+bool OrderBook::wouldCross(Price price) {
+    constexpr OrderSide Opposite = S == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+    auto& book = ladder<Opposite>();
+
+    return !book.empty() && !book.isBetter(price, book.bestPrice());
 }
 
-Trade OrderBook::executeTrade(OrderPtr buyOrder, OrderPtr sellOrder,
-                               double price, double quantity) {
-    buyOrder->filledQuantity += quantity;
-    sellOrder->filledQuantity += quantity;
+template <OrderSide S, OrderType T>
+bool OrderBook::canFill(Price price, Quantity quantity) {
+    constexpr OrderSide Opposite = S == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+    auto& book = ladder<Opposite>();
+
+    Quantity available = 0;
+    book.forEach([&](const PriceLevel& level) {
+        if (T == OrderType::LIMIT && book.isBetter(price, level.price)) {
+            return false;
+        }
+        available += level.totalQuantity;
+        return available < quantity;
+    });
 
-    if (buyOrder->isFilled()) {
-        buyOrder->status = OrderStatus::FILLED;
-    } else if (buyOrder->filledQuantity > 0) {
-        buyOrder->status = OrderStatus::PARTIAL;
+    return available >= quantity;
+}
+
+template <OrderSide S>
+PriceLadder<S>& OrderBook::ladder() {
+    if constexpr (S == OrderSide::BUY) {
+        return bids_;
+    } else {
+        return asks_;
     }
+}
 
-    if (sellOrder->isFilled()) {
-        sellOrder->status = OrderStatus::FILLED;
-    } else if (sellOrder->filledQuantity > 0) {
-        sellOrder->status = OrderStatus::PARTIAL;
+template <OrderSide S>
+auto& OrderBook::stopLadder() {
+    if constexpr (S == OrderSide::BUY) {
+        return buyStops_;
+    } else {
+        return sellStops_;
+    }
+}
+
+template <OrderSide S>
+void OrderBook::addStop(RestingOrder* order) {
+    stopLadder<S>().insert(pool_.details(order).stopPrice).pushBack(order);
+    linkUserOrder(order);
+}
+
+template <OrderSide S>
+void OrderBook::removeStop(RestingOrder* order) {
+    auto& stops = stopLadder<S>();
+    Price stopPrice = pool_.details(order).stopPrice;
+
+    PriceLevel* level = stops.find(stopPrice);
+    level->unlink(order);
+    if (level->empty()) {
+        stops.erase(stopPrice);
+    }
+}
+
+template <OrderSide S>
+void OrderBook::rest(RestingOrder* order) {
+    PriceLevel& level = ladder<S>().insert(order->price);
+    level.pushBack(order);
+    publishLevel(S, level);
+    linkUserOrder(order);
+}
+
+template <OrderSide S>
+void OrderBook::unlinkResting(RestingOrder* order) {
+    detachFromLevel<S>(order);
+    unlinkUserOrder(order);
+}
+
+template <OrderSide S>
+void OrderBook::detachFromLevel(RestingOrder* order) {
+    auto& book = ladder<S>();
+
+    PriceLevel* priceLevel = book.find(order->price);
+    if (priceLevel) {
+        priceLevel->unlink(order);
+        publishLevel(S, *priceLevel);
+
+        if (priceLevel->empty()) {
+            book.erase(order->price);
+        }
+    }
+}
+
+template <OrderSide S>
+bool OrderBook::amendResting(RestingOrder* order, Price newPrice, Quantity newQuantity,
+                             TradeSink sink) {
+    // Nothing left to rest
+    if (newQuantity <= order->filledQuantity) {
+        unlinkResting<S>(order);
+        retireOrder(order, OrderStatus::CANCELLED);
+        return true;
+    }
+
+    // Size-down at the same price keeps the order's place in the queue
+    if (newPrice == order->price && newQuantity <= order->quantity) {
+        PriceLevel& level = *ladder<S>().find(order->price);
+        level.reduce(order->quantity - newQuantity);
+        order->quantity = newQuantity;
+        publishLevel(S, level);
+        return true;
+    }
+
+    if (order->type == OrderType::POST_ONLY && wouldCross<S>(newPrice)) {
+        return false;
+    }
+
+    // Otherwise the same Order moves to the back of its new level. It stays
+    // in orders_ and in its user's list throughout.
+    detachFromLevel<S>(order);
+
+    auto now = std::chrono::system_clock::now();
+    order->price = newPrice;
+    order->quantity = newQuantity;
+    pool_.details(order).timestamp = now;
+
+    if (order->type != OrderType::POST_ONLY) {
+        StageTimer<> timer(stats_.match);
+        match<S, OrderType::LIMIT>(*order, sink, now);
+    }
+
+    if (order->isFilled()) {
+        unlinkUserOrder(order);
+        retireOrder(order, OrderStatus::FILLED);
+    } else {
+        PriceLevel& level = ladder<S>().insert(order->price);
+        level.pushBack(order);
+        publishLevel(S, level);
+    }
+    return true;
+}
+
+Trade OrderBook::executeTrade(RestingOrder& buyOrder, RestingOrder& sellOrder,
+                               Price price, Quantity quantity,
+                               std::chrono::system_clock::time_point now) {
+    buyOrder.filledQuantity += quantity;
+    sellOrder.filledQuantity += quantity;
+
+    if (buyOrder.isFilled()) {
+        buyOrder.status = OrderStatus::FILLED;
+    } else if (buyOrder.filledQuantity > 0) {
+        buyOrder.status = OrderStatus::PARTIAL;
+    }
+
+    if (sellOrder.isFilled()) {
+        sellOrder.status = OrderStatus::FILLED;
+    } else if (sellOrder.filledQuantity > 0) {
+        sellOrder.status = OrderStatus::PARTIAL;
     }
 
     return Trade{
-        buyOrder->id,
-        sellOrder->id,
+        buyOrder.id,
+        sellOrder.id,
         price,
         quantity,
-        std::chrono::system_clock::now()
+        now
     };
 }
 
 bool OrderBook::cancelOrder(uint64_t orderId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    CountingLock lock(mutex_, stats_.lock);
 
-    auto it = orders_.find(orderId);
-    if (it == orders_.end()) {
+    // Only resting orders are in orders_
+    RestingOrder* order = orders_.find(orderId);
+    if (!order) {
         return false;
     }
 
-    auto order = it->second;
+    // Logged before the book changes, so a failed append leaves it as it was
+    journalChange(JournalRecord::Type::CANCEL, orderId);
 
-    // Remove from bid/ask book
-    if (order->side == OrderSide::BUY) {
-        auto priceLevel = bids_.find(order->price);
-        if (priceLevel != bids_.end()) {
-            auto& orders = priceLevel->second;
-            orders.erase(
-                std::remove(orders.begin(), orders.end(), order),
-                orders.end()
-            );
+    removeOpenOrder(order);
+    retireOrder(order, OrderStatus::CANCELLED);
+    publishSnapshot();
 
-            if (orders.empty()) {
-                bids_.erase(priceLevel);
-            }
+    return true;
+}
+
+size_t OrderBook::expireOrders(std::chrono::system_clock::time_point now) {
+    CountingLock lock(mutex_, stats_.lock);
+
+    // A failed append leaves its order on the book and back on the wheel;
+    // whatever expired before it is still published
+    size_t expired = 0;
+    try {
+        expired = expiries_.advance(toNanos(now), [this](RestingOrder* order) {
+            journalChange(JournalRecord::Type::EXPIRE, order->id);
+            removeOpenOrder(order);
+            retireOrder(order, OrderStatus::EXPIRED);
+        });
+    } catch (...) {
+        publishSnapshot();
+        throw;
+    }
+
+    if (expired) {
+        publishSnapshot();
+    }
+    return expired;
+}
+
+bool OrderBook::expireOrder(uint64_t orderId) {
+    CountingLock lock(mutex_, stats_.lock);
+
+    RestingOrder* order = orders_.find(orderId);
+    if (!order) {
+        return false;
+    }
+
+    journalChange(JournalRecord::Type::EXPIRE, orderId);
+
+    removeOpenOrder(order);
+    retireOrder(order, OrderStatus::EXPIRED);
+    publishSnapshot();
+
+    return true;
+}
+
+void OrderBook::removeOpenOrder(RestingOrder* order) {
+    // Remove from bid/ask book, or from the stop orders
+    if (isStop(order->type)) {
+        if (order->side == OrderSide::BUY) {
+            removeStop<OrderSide::BUY>(order);
+        } else {
+            removeStop<OrderSide::SELL>(order);
         }
+        unlinkUserOrder(order);
+    } else if (order->side == OrderSide::BUY) {
+        unlinkResting<OrderSide::BUY>(order);
     } else {
-        auto priceLevel = asks_.find(order->price);
-        if (priceLevel != asks_.end()) {
-            auto& orders = priceLevel->second;
-            orders.erase(
-                std::remove(orders.begin(), orders.end(), order),
-                orders.end()
-            );
+        unlinkResting<OrderSide::SELL>(order);
+    }
+}
 
-            if (orders.empty()) {
-                asks_.erase(priceLevel);
-            }
-        }
+bool OrderBook::amendOrder(uint64_t orderId, Price newPrice, Quantity newQuantity,
+                           TradeSink sink) {
+    CountingLock lock(mutex_, stats_.lock);
+
+    RestingOrder* order = orders_.find(orderId);
+    if (!order || isStop(order->type)) {
+        return false;
     }
 
-    order->status = OrderStatus::CANCELLED;
-    orders_.erase(it);
+    // Logged before it executes, like a submit; replay makes the same
+    // decision for an amend that turns out to be rejected
+    journalChange(JournalRecord::Type::AMEND, orderId, newPrice, newQuantity);
 
-    return true;
+    bool amended = order->side == OrderSide::BUY
+        ? amendResting<OrderSide::BUY>(order, newPrice, newQuantity, sink)
+        : amendResting<OrderSide::SELL>(order, newPrice, newQuantity, sink);
+
+    if (amended) {
+        triggerStops(sink);
+        publishSnapshot();
+    }
+
+    return amended;
 }
 
-double OrderBook::getBestBid() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return bids_.empty() ? 0.0 : bids_.begin()->first;
+bool OrderBook::amendOrder(uint64_t orderId, Price newPrice, Quantity newQuantity,
+                           std::vector<Trade>& trades) {
+    return amendOrder(orderId, newPrice, newQuantity,
+                      [&trades](const Trade& trade) { trades.push_back(trade); });
 }
 
-double OrderBook::getBestAsk() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return asks_.empty() ? 0.0 : asks_.begin()->first;
+Price OrderBook::getBestBid() const {
+    return snapshot_.load().bestBid;
 }
 
-std::map<double, double> OrderBook::getBidDepth(int levels) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::map<double, double> depth;
+Price OrderBook::getBestAsk() const {
+    return snapshot_.load().bestAsk;
+}
 
-    int count = 0;
-    for (const auto& [price, orders] : bids_) {
-        if (count++ >= levels) break;
+BookSnapshot OrderBook::getSnapshot() const {
+    return snapshot_.load();
+}
 
-        double totalQuantity = 0.0;
-        for (const auto& order : orders) {
-            totalQuantity += order->getRemainingQuantity();
-        }
-        depth[price] = totalQuantity;
+std::map<Price, Quantity> OrderBook::getBidDepth(int levels) const {
+    return getDepth(OrderSide::BUY, levels);
+}
+
+std::map<Price, Quantity> OrderBook::getAskDepth(int levels) const {
+    return getDepth(OrderSide::SELL, levels);
+}
+
+size_t OrderBook::getBidDepth(DepthLevel* out, size_t maxLevels) const {
+    return getDepth(OrderSide::BUY, out, maxLevels);
+}
+
+size_t OrderBook::getAskDepth(DepthLevel* out, size_t maxLevels) const {
+    return getDepth(OrderSide::SELL, out, maxLevels);
+}
+
+std::map<Price, Quantity> OrderBook::getDepth(OrderSide side, int levels) const {
+    std::map<Price, Quantity> depth;
+    if (levels <= 0) {
+        return depth;
     }
 
+    std::vector<DepthLevel> buffer(static_cast<size_t>(levels));
+    size_t count = getDepth(side, buffer.data(), buffer.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        depth[buffer[i].price] = buffer[i].quantity;
+    }
     return depth;
 }
 
-std::map<double, double> OrderBook::getAskDepth(int levels) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::map<double, double> depth;
+size_t OrderBook::getDepth(OrderSide side, DepthLevel* out, size_t maxLevels) const {
+    // Shallow queries are served from the snapshot without taking the lock
+    if (maxLevels <= BookSnapshot::kDepth) {
+        BookSnapshot snapshot = snapshot_.load();
+        const DepthLevel* source = side == OrderSide::BUY ? snapshot.bids : snapshot.asks;
+        size_t count = std::min<size_t>(maxLevels,
+            side == OrderSide::BUY ? snapshot.bidLevels : snapshot.askLevels);
 
-    int count = 0;
-    for (const auto& [price, orders] : asks_) {
-        if (count++ >= levels) break;
+        std::copy(source, source + count, out);
+        return count;
+    }
 
-        double totalQuantity = 0.0;
-        for (const auto& order : orders) {
-            totalQuantity += order->getRemainingQuantity();
-        }
-        depth[price] = totalQuantity;
+    CountingLock lock(mutex_, stats_.lock);
+    return side == OrderSide::BUY
+        ? collectDepth(bids_, out, maxLevels)
+        : collectDepth(asks_, out, maxLevels);
+}
+
+void OrderBook::publishSnapshot() {
+    StageTimer<> timer(stats_.publish);
+
+    BookSnapshot snapshot;
+    snapshot.version = ++version_;
+    snapshot.bestBid = bids_.bestPrice();
+    snapshot.bestAsk = asks_.bestPrice();
+    snapshot.bidLevels = static_cast<uint32_t>(collectDepth(bids_, snapshot.bids, BookSnapshot::kDepth));
+    snapshot.askLevels = static_cast<uint32_t>(collectDepth(asks_, snapshot.asks, BookSnapshot::kDepth));
+
+    snapshot_.store(snapshot);
+
+    if (feed_ && feed_->snapshotDue()) {
+        publishL2Snapshot();
     }
+}
 
-    return depth;
+void OrderBook::publishL2Snapshot() {
+    auto snapshot = std::make_shared<L2Snapshot>();
+    snapshot->sequence = feed_->lastSequence();
+
+    auto copyLevel = [](std::vector<DepthLevel>& out) {
+        return [&out](const PriceLevel& level) {
+            out.push_back(DepthLevel{level.price, level.totalQuantity, level.orderCount});
+            return true;
+        };
+    };
+    bids_.forEach(copyLevel(snapshot->bids));
+    asks_.forEach(copyLevel(snapshot->asks));
+
+    feed_->publishSnapshot(std::move(snapshot));
+}
+
+void OrderBook::enableL2Feed(const L2Feed::Options& options) {
+    CountingLock lock(mutex_, stats_.lock);
+    if (feed_) {
+        return;
+    }
+
+    feed_ = std::make_unique<L2Feed>(options, &arena_);
+    publishL2Snapshot();
+}
+
+std::vector<Order> OrderBook::getUserOrders(UserId userId) const {
+    std::vector<Order> userOrders;
+    appendUserOrders(userId, userOrders);
+    return userOrders;
+}
+
+size_t OrderBook::appendUserOrders(UserId userId, std::vector<Order>& out) const {
+    CountingLock lock(mutex_, stats_.lock);
+
+    auto it = userOrders_.find(userId);
+    if (it == userOrders_.end()) {
+        return 0;
+    }
+
+    out.reserve(out.size() + it->second.count);
+    for (const RestingOrder* order = it->second.head; order;
+         order = pool_.details(order).userNext) {
+        out.push_back(toOrder(*order));
+    }
+
+    return it->second.count;
+}
+
+void OrderBook::setJournal(Journal* journal) {
+    CountingLock lock(mutex_, stats_.lock);
+    journal_ = journal;
 }
 
-std::vector<OrderPtr> OrderBook::getUserOrders(const std::string& userId) const {
+void OrderBook::setSettlement(Settlement* settlement) {
+    CountingLock lock(mutex_, stats_.lock);
+    settlement_ = settlement;
+}
+
+void OrderBook::journalOrder(const NewOrder& order) {
+    if (!journal_) {
+        return;
+    }
+
+    JournalRecord record;
+    record.type = JournalRecord::Type::SUBMIT;
+    record.pairId = pairId_;
+    record.userId = order.userId;
+    record.orderId = order.orderId;
+    record.side = order.side;
+    record.orderType = order.type;
+    record.timeInForce = order.timeInForce;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.stopPrice = order.stopPrice;
+    record.expireTime = order.expireTime;
+    journalSequence_ = journal_->append(std::move(record));
+}
+
+void OrderBook::journalChange(JournalRecord::Type type, uint64_t orderId,
+                              Price price, Quantity quantity) {
+    if (!journal_) {
+        return;
+    }
+
+    JournalRecord record;
+    record.type = type;
+    record.pairId = pairId_;
+    record.orderId = orderId;
+    record.price = price;
+    record.quantity = quantity;
+    journalSequence_ = journal_->append(std::move(record));
+}
+
+BookStats OrderBook::getStats() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<OrderPtr> userOrders;
+    return stats_;
+}
+
+size_t OrderBook::getMappedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return arena_.mappedBytes();
+}
+
+uint64_t OrderBook::getJournalSequence() const {
+    CountingLock lock(mutex_, stats_.lock);
+    return journalSequence_;
+}
+
+void OrderBook::markJournaled(uint64_t sequence) {
+    CountingLock lock(mutex_, stats_.lock);
+    journalSequence_ = sequence;
+}
 
-    for (const auto& [id, order] : orders_) {
-        if (order->userId == userId) {
-            userOrders.push_back(order);
+void OrderBook::exportImage(BookImage& image) const {
+    CountingLock lock(mutex_, stats_.lock);
+
+    image.tradingPair = tradingPair_;
+    image.pairId = pairId_;
+    image.spec = spec_;
+    image.journalSequence = journalSequence_;
+    image.lastPrice = lastPrice_;
+    image.orders.clear();
+    image.orders.reserve(pool_.size());
+
+    auto copyLevel = [this, &image](const PriceLevel& level) {
+        for (const RestingOrder* order = level.head; order; order = order->next) {
+            image.orders.push_back(SnapshotOrder{
+                order->id, order->userId, order->side, order->type, order->timeInForce,
+                order->status, order->price, order->quantity, order->filledQuantity,
+                toNanos(pool_.details(order).timestamp),
+                pool_.details(order).stopPrice, pool_.details(order).expireTime});
         }
+        return true;
+    };
+    bids_.forEach(copyLevel);
+    asks_.forEach(copyLevel);
+    buyStops_.forEach(copyLevel);
+    sellStops_.forEach(copyLevel);
+}
+
+void OrderBook::restoreImage(const SnapshotOrder* orders, size_t count,
+                             uint64_t journalSequence, Price lastPrice) {
+    CountingLock lock(mutex_, stats_.lock);
+
+    if (!orders_.empty()) {
+        throw std::logic_error("Snapshots can only be restored into an empty book");
     }
 
-    return userOrders;
+    pool_.reserve(count);
+    orders_.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const SnapshotOrder& saved = orders[i];
+
+        RestingOrder* order = pool_.allocate(saved.id, saved.userId, saved.side, saved.type,
+                                             saved.timeInForce, saved.price, saved.quantity);
+        pool_.details(order).timestamp = fromNanos(saved.timestamp);
+        pool_.details(order).stopPrice = saved.stopPrice;
+        order->status = saved.status;
+        order->filledQuantity = saved.filledQuantity;
+        if (!orders_.insert(order->id, order)) {
+            pool_.release(order);
+            throw std::invalid_argument("Duplicate order ID");
+        }
+        if (order->timeInForce == TimeInForce::GTD) {
+            pool_.details(order).expireTime = saved.expireTime;
+            expiries_.schedule(order, saved.expireTime);
+        }
+
+        if (isStop(order->type)) {
+            if (order->side == OrderSide::BUY) {
+                addStop<OrderSide::BUY>(order);
+            } else {
+                addStop<OrderSide::SELL>(order);
+            }
+        } else if (order->side == OrderSide::BUY) {
+            rest<OrderSide::BUY>(order);
+        } else {
+            rest<OrderSide::SELL>(order);
+        }
+    }
+
+    journalSequence_ = journalSequence;
+    lastPrice_ = lastPrice;
+    publishSnapshot();
+}
+
+bool OrderBook::getOrder(uint64_t orderId, Order& order) const {
+    CountingLock lock(mutex_, stats_.lock);
+
+    if (const RestingOrder* live = orders_.find(orderId)) {
+        order = toOrder(*live);
+        return true;
+    }
+
+    const OrderRecord* record = recent_.find(orderId);
+    if (!record) {
+        return false;
+    }
+
+    order = Order(record->id, record->userId, pairId_, record->side, record->type,
+                  record->price, record->quantity, record->timestamp, record->timeInForce);
+    order.status = record->status;
+    order.filledQuantity = record->filledQuantity;
+    order.stopPrice = record->stopPrice;
+    if (record->timeInForce == TimeInForce::GTD) {
+        order.expireTime = fromNanos(record->expireTime);
+    }
+    return true;
+}
+
+size_t OrderBook::getOrderCount() const {
+    CountingLock lock(mutex_, stats_.lock);
+    return orders_.size();
+}
+
+Price OrderBook::getLastPrice() const {
+    CountingLock lock(mutex_, stats_.lock);
+    return lastPrice_;
+}
+
+void OrderBook::setRecentOrderCapacity(size_t capacity) {
+    CountingLock lock(mutex_, stats_.lock);
+    recent_.setCapacity(capacity);
+}
+
+void OrderBook::retireOrder(RestingOrder* order, OrderStatus status) {
+    if (order->timeInForce == TimeInForce::GTD) {
+        expiries_.cancel(order);
+    }
+
+    order->status = status;
+    recent_.push(OrderRecord{order->id, order->userId, order->side, order->type,
+                             order->timeInForce, status, order->price, order->quantity,
+                             order->filledQuantity, pool_.details(order).timestamp,
+                             pool_.details(order).stopPrice, pool_.details(order).expireTime});
+
+    orders_.erase(order->id);
+    pool_.release(order);
+}
+
+Order OrderBook::toOrder(const RestingOrder& resting) const {
+    Order order(resting.id, resting.userId, pairId_, resting.side, resting.type, resting.price,
+                resting.quantity, pool_.details(&resting).timestamp, resting.timeInForce);
+    order.status = resting.status;
+    order.filledQuantity = resting.filledQuantity;
+    order.stopPrice = pool_.details(&resting).stopPrice;
+    if (resting.timeInForce == TimeInForce::GTD) {
+        order.expireTime = fromNanos(pool_.details(&resting).expireTime);
+    }
+    return order;
+}
+
+void OrderBook::recordRejected(const NewOrder& request, OrderStatus status) {
+    if (recent_.capacity() == 0) {
+        return;
+    }
+
+    recent_.push(OrderRecord{request.orderId, request.userId, request.side, request.type,
+                             request.timeInForce, status, request.price, request.quantity,
+                             0, std::chrono::system_clock::now(), request.stopPrice,
+                             request.expireTime});
+}
+
+void OrderBook::linkUserOrder(RestingOrder* order) {
+    UserOrders& list = userOrders_[order->userId];
+    OrderDetails& details = pool_.details(order);
+
+    details.userPrev = nullptr;
+    details.userNext = list.head;
+    if (list.head) {
+        pool_.details(list.head).userPrev = order;
+    }
+    list.head = order;
+    ++list.count;
+}
+
+void OrderBook::unlinkUserOrder(RestingOrder* order) {
+    // Every linked order has an entry
+    UserOrders& list = userOrders_.find(order->userId)->second;
+    OrderDetails& details = pool_.details(order);
+
+    if (details.userPrev) {
+        pool_.details(details.userPrev).userNext = details.userNext;
+    } else {
+        list.head = details.userNext;
+    }
+    if (details.userNext) {
+        pool_.details(details.userNext).userPrev = details.userPrev;
+    }
+    details.userPrev = details.userNext = nullptr;
+    --list.count;
 }
 
 } // namespace DEX
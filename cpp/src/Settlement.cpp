@@ -0,0 +1,278 @@
+#include "../include/Settlement.hpp"
+#include "keccak.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+namespace DEX {
+
+namespace {
+
+constexpr size_t kLeafSize = 52;
+
+// Same idle policy as the journal writer
+constexpr unsigned kIdleSpins = 4096;
+constexpr auto kIdleSleep = std::chrono::microseconds(50);
+
+template <typename T>
+uint8_t* putBigEndian(uint8_t* out, T value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(bits >> (8 * (sizeof(T) - 1 - i)));
+    }
+    return out + sizeof(T);
+}
+
+void encodeLeaf(const SettledTrade& settled, uint8_t* out) {
+    const Trade& trade = settled.trade;
+    int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        trade.timestamp.time_since_epoch()).count();
+
+    out = putBigEndian(out, settled.sequence);
+    out = putBigEndian(out, settled.pairId);
+    out = putBigEndian(out, trade.buyOrderId);
+    out = putBigEndian(out, trade.sellOrderId);
+    out = putBigEndian(out, trade.price);
+    out = putBigEndian(out, trade.quantity);
+    putBigEndian(out, nanos);
+}
+
+// Smaller hash first, so proofs need no left/right flags
+void orderPair(const Hash256& a, const Hash256& b, uint8_t* out) {
+    const Hash256& low = a < b ? a : b;
+    const Hash256& high = a < b ? b : a;
+    std::memcpy(out, low.data(), low.size());
+    std::memcpy(out + low.size(), high.data(), high.size());
+}
+
+Hash256 hashPair(const Hash256& a, const Hash256& b) {
+    uint8_t pair[64];
+    orderPair(a, b, pair);
+
+    Hash256 out;
+    keccak256(pair, sizeof(pair), out.data());
+    return out;
+}
+
+// keccak256 of count messages of `size` bytes stored back to back
+void hashAll(const std::vector<uint8_t>& messages, size_t size, size_t count, Hash256* out) {
+    std::vector<const uint8_t*> inputs(count);
+    std::vector<size_t> lengths(count, size);
+    for (size_t i = 0; i < count; ++i) {
+        inputs[i] = messages.data() + i * size;
+    }
+
+    static_assert(sizeof(Hash256) == KECCAK256_HASH_SIZE, "Hash256 must be a bare digest");
+    keccak256_batch(inputs.data(), lengths.data(), count, reinterpret_cast<uint8_t*>(out));
+}
+
+void buildTree(SettlementBatch& batch) {
+    const size_t count = batch.trades.size();
+    std::vector<uint8_t> messages(count * kLeafSize);
+    for (size_t i = 0; i < count; ++i) {
+        encodeLeaf(batch.trades[i], messages.data() + i * kLeafSize);
+    }
+
+    batch.levels.clear();
+    batch.levels.emplace_back(count);
+    hashAll(messages, kLeafSize, count, batch.levels.back().data());
+
+    while (batch.levels.back().size() > 1) {
+        const std::vector<Hash256>& below = batch.levels.back();
+        size_t pairs = below.size() / 2;
+
+        messages.resize(pairs * 64);
+        for (size_t i = 0; i < pairs; ++i) {
+            orderPair(below[2 * i], below[2 * i + 1], messages.data() + i * 64);
+        }
+
+        std::vector<Hash256> level(pairs + below.size() % 2);
+        hashAll(messages, 64, pairs, level.data());
+        if (below.size() % 2) {
+            level.back() = below.back();
+        }
+        batch.levels.push_back(std::move(level));
+    }
+}
+
+} // namespace
+
+std::vector<Hash256> SettlementBatch::proof(size_t index) const {
+    if (index >= trades.size()) {
+        throw std::out_of_range("No such trade in batch");
+    }
+
+    std::vector<Hash256> path;
+    for (size_t level = 0; level + 1 < levels.size(); ++level) {
+        size_t sibling = index ^ 1;
+        if (sibling < levels[level].size()) {
+            path.push_back(levels[level][sibling]);
+        }
+        index /= 2;
+    }
+    return path;
+}
+
+Hash256 SettlementBatch::leafHash(const SettledTrade& trade) {
+    uint8_t leaf[kLeafSize];
+    encodeLeaf(trade, leaf);
+
+    Hash256 out;
+    keccak256(leaf, sizeof(leaf), out.data());
+    return out;
+}
+
+bool SettlementBatch::verify(const Hash256& leaf, const std::vector<Hash256>& proof,
+                             const Hash256& root) {
+    Hash256 node = leaf;
+    for (const Hash256& sibling : proof) {
+        node = hashPair(node, sibling);
+    }
+    return node == root;
+}
+
+Settlement::Settlement(BatchHandler handler) : Settlement(std::move(handler), Options{}) {}
+
+Settlement::Settlement(BatchHandler handler, const Options& options)
+    : handler_(std::move(handler)), options_(options), queue_(options.queueCapacity) {
+    if (!handler_) {
+        throw std::invalid_argument("Settlement needs a batch handler");
+    }
+    if (options_.maxTrades == 0) {
+        throw std::invalid_argument("Settlement batches need room for at least one trade");
+    }
+
+    worker_ = std::thread([this] { run(); });
+}
+
+Settlement::~Settlement() {
+    running_ = false;
+    worker_.join();
+}
+
+uint64_t Settlement::add(PairId pairId, const Trade& trade) noexcept {
+    // Same shutdown handshake as Journal::append
+    producers_.fetch_add(1);
+
+    if (!running_ || failed_) {
+        producers_.fetch_sub(1);
+        return 0;
+    }
+
+    uint64_t sequence = ++sequence_;
+    SettledTrade settled{sequence, pairId, trade};
+
+    while (!queue_.tryPush(std::move(settled))) {
+        if (failed_) {
+            producers_.fetch_sub(1);
+            return 0;
+        }
+        std::this_thread::yield();
+    }
+
+    ++added_;
+    producers_.fetch_sub(1);
+    return sequence;
+}
+
+void Settlement::flush() {
+    uint64_t target = added_.load();
+
+    flushWaiters_.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        settledSignal_.wait(lock, [&] { return settled_.load() >= target || !error_.empty(); });
+    }
+    flushWaiters_.fetch_sub(1);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_.empty()) {
+        throw std::runtime_error("Settlement handler failed: " + error_);
+    }
+}
+
+void Settlement::run() {
+    std::vector<SettledTrade> pending;
+    pending.reserve(options_.maxTrades);
+    std::chrono::steady_clock::time_point opened;
+    SettledTrade settled;
+    unsigned idle = 0;
+
+    for (;;) {
+        // Once no producer can push any more, one last drain and we are done
+        bool stopping = !running_ && producers_.load() == 0;
+
+        bool drained = false;
+        while (pending.size() < options_.maxTrades && queue_.tryPop(settled)) {
+            if (pending.empty()) {
+                opened = std::chrono::steady_clock::now();
+            }
+            pending.push_back(settled);
+            drained = true;
+        }
+
+        if (!pending.empty()) {
+            bool full = pending.size() >= options_.maxTrades;
+            bool due = std::chrono::steady_clock::now() - opened >= options_.interval;
+            bool flushing = flushWaiters_.load() > 0 && !drained;
+
+            if (full || due || flushing || stopping) {
+                if (!emit(pending)) {
+                    return;
+                }
+                idle = 0;
+                continue;
+            }
+        }
+
+        if (stopping) {
+            return;
+        }
+
+        if (drained) {
+            idle = 0;
+        } else if (++idle < kIdleSpins) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+}
+
+bool Settlement::emit(std::vector<SettledTrade>& trades) {
+    SettlementBatch batch;
+    batch.sequence = batches_.load() + 1;
+    batch.trades.swap(trades);
+    trades.reserve(options_.maxTrades);
+
+    std::string error;
+    try {
+        buildTree(batch);
+        handler_(batch);
+    } catch (const std::exception& e) {
+        error = e.what();
+    } catch (...) {
+        error = "unknown exception";
+    }
+
+    if (!error.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = error;
+        }
+        failed_ = true;
+        settledSignal_.notify_all();
+        return false;
+    }
+
+    ++batches_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        settled_ += batch.trades.size();
+    }
+    settledSignal_.notify_all();
+    return true;
+}
+
+} // namespace DEX
@@ -0,0 +1,286 @@
+#include "../include/ShardedEngine.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace DEX {
+
+namespace {
+
+// Spins before a shard thread starts yielding while idle
+constexpr unsigned kIdleSpins = 4096;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// False if the thread stays unpinned, e.g. for a CPU outside its allowed set
+bool pinCurrentThread(size_t cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % CPU_SETSIZE, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace
+
+ShardedEngine::ShardedEngine() : ShardedEngine(Options{}) {}
+
+ShardedEngine::ShardedEngine(const Options& options) : options_(options) {
+    BookArena::validate(options_.bookMemory.arena);
+
+    size_t count = options_.shardCount;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(options_.queueCapacity));
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+bool ShardedEngine::addTradingPair(const std::string& pair, const PairSpec& spec) {
+    auto leastLoaded = std::min_element(shards_.begin(), shards_.end(),
+        [](const auto& a, const auto& b) { return a->pairCount < b->pairCount; });
+
+    return addTradingPair(pair, static_cast<size_t>(leastLoaded - shards_.begin()), spec);
+}
+
+bool ShardedEngine::addTradingPair(const std::string& pair, size_t shard, const PairSpec& spec) {
+    if (running_) {
+        throw std::logic_error("Trading pairs must be added before start()");
+    }
+
+    if (shard >= shards_.size()) {
+        throw std::out_of_range("Shard index out of range");
+    }
+
+    // Keep the book on the memory node its matching thread runs on
+    BookMemory memory = options_.bookMemory;
+    if (options_.pinThreads && memory.arena.numaNode < 0 && BookArena::nodeCount() > 1) {
+        memory.arena.numaNode = BookArena::nodeOfCpu(shard);
+    }
+
+    PairId pairId = engine_.addTradingPair(pair, spec, memory);
+    if (pairId == MatchingEngine::kInvalidPairId) {
+        return false;
+    }
+
+    routes_[pair] = Route{engine_.getOrderBook(pairId), shards_[shard].get()};
+    ++shards_[shard]->pairCount;
+    return true;
+}
+
+void ShardedEngine::attachJournal(Journal* journal) {
+    if (running_) {
+        throw std::logic_error("The journal must be attached before start()");
+    }
+
+    engine_.attachJournal(journal);
+}
+
+void ShardedEngine::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        Shard& shard = *shards_[i];
+        shard.thread = std::thread([this, &shard, i] { run(shard, i); });
+    }
+}
+
+void ShardedEngine::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    for (auto& shard : shards_) {
+        shard->thread.join();
+    }
+}
+
+void ShardedEngine::submitOrder(const std::string& userId,
+                                const std::string& tradingPair,
+                                OrderSide side,
+                                OrderType type,
+                                double price,
+                                double quantity,
+                                SubmitCallback onComplete,
+                                TimeInForce timeInForce) {
+    Command command;
+    command.reply = std::move(onComplete);
+    submit(userId, tradingPair, side, type, price, quantity, timeInForce, std::move(command));
+}
+
+std::future<SubmitResult> ShardedEngine::submitOrder(const std::string& userId,
+                                                     const std::string& tradingPair,
+                                                     OrderSide side,
+                                                     OrderType type,
+                                                     double price,
+                                                     double quantity,
+                                                     TimeInForce timeInForce) {
+    Command command;
+    auto& promise = command.reply.emplace<std::promise<SubmitResult>>();
+    std::future<SubmitResult> future = promise.get_future();
+
+    submit(userId, tradingPair, side, type, price, quantity, timeInForce, std::move(command));
+    return future;
+}
+
+void ShardedEngine::cancelOrder(uint64_t orderId, const std::string& tradingPair,
+                                CancelCallback onComplete) {
+    Command command;
+    command.reply = std::move(onComplete);
+    cancel(orderId, tradingPair, std::move(command));
+}
+
+std::future<bool> ShardedEngine::cancelOrder(uint64_t orderId, const std::string& tradingPair) {
+    Command command;
+    auto& promise = command.reply.emplace<std::promise<bool>>();
+    std::future<bool> future = promise.get_future();
+
+    cancel(orderId, tradingPair, std::move(command));
+    return future;
+}
+
+void ShardedEngine::submit(const std::string& userId, const std::string& tradingPair,
+                           OrderSide side, OrderType type, double price, double quantity,
+                           TimeInForce timeInForce, Command&& command) {
+    const Route& target = route(tradingPair);
+
+    command.kind = Command::Kind::SUBMIT;
+    command.book = target.book;
+    command.userId = engine_.internUser(userId);
+    command.side = side;
+    command.type = type;
+    command.timeInForce = timeInForce;
+    command.price = price;
+    command.quantity = quantity;
+
+    enqueue(*target.shard, std::move(command));
+}
+
+void ShardedEngine::cancel(uint64_t orderId, const std::string& tradingPair, Command&& command) {
+    const Route& target = route(tradingPair);
+
+    command.kind = Command::Kind::CANCEL;
+    command.book = target.book;
+    command.orderId = orderId;
+
+    enqueue(*target.shard, std::move(command));
+}
+
+const ShardedEngine::Route& ShardedEngine::route(const std::string& tradingPair) const {
+    auto it = routes_.find(tradingPair);
+    if (it == routes_.end()) {
+        throw std::runtime_error("Trading pair not found: " + tradingPair);
+    }
+    return it->second;
+}
+
+void ShardedEngine::enqueue(Shard& shard, Command&& command) {
+    // Registered as a producer before checking running_, so stop() can't
+    // let the shard exit while this push is still on its way
+    producers_.fetch_add(1);
+
+    if (!running_) {
+        producers_.fetch_sub(1);
+        throw std::logic_error("ShardedEngine is not running");
+    }
+
+    while (!shard.queue.tryPush(std::move(command))) {
+        std::this_thread::yield();
+    }
+
+    producers_.fetch_sub(1);
+}
+
+void ShardedEngine::run(Shard& shard, size_t index) {
+    if (options_.pinThreads && !pinCurrentThread(index)) {
+        ++unpinned_;
+    }
+
+    Command command;
+    unsigned idle = 0;
+
+    for (;;) {
+        if (shard.queue.tryPop(command)) {
+            execute(command);
+            command = Command();
+            idle = 0;
+            continue;
+        }
+
+        // Exit only once no producer can still push into this queue
+        if (!running_ && producers_.load() == 0) {
+            if (!shard.queue.tryPop(command)) {
+                return;
+            }
+            execute(command);
+            command = Command();
+            continue;
+        }
+
+        if (++idle < kIdleSpins) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ShardedEngine::execute(Command& command) {
+    if (command.kind == Command::Kind::CANCEL) {
+        bool cancelled = command.book->cancelOrder(command.orderId);
+        if (auto* callback = std::get_if<CancelCallback>(&command.reply)) {
+            if (*callback) {
+                (*callback)(cancelled);
+            }
+        } else if (auto* promise = std::get_if<std::promise<bool>>(&command.reply)) {
+            promise->set_value(cancelled);
+        }
+        return;
+    }
+
+    SubmitResult result{};
+    std::exception_ptr error;
+
+    try {
+        result.order = engine_.submitOrder(*command.book, command.userId, command.side,
+                                           command.type, command.price, command.quantity,
+                                           [&result](const Trade& trade) { result.trades.push_back(trade); },
+                                           command.timeInForce);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    if (auto* callback = std::get_if<SubmitCallback>(&command.reply)) {
+        if (*callback) {
+            (*callback)(std::move(result), error);
+        }
+    } else if (auto* promise = std::get_if<std::promise<SubmitResult>>(&command.reply)) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(result));
+        }
+    }
+}
+
+} // namespace DEX
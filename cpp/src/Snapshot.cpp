@@ -0,0 +1,221 @@
+#include "../include/Snapshot.hpp"
+#include "../include/MatchingEngine.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DEX {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'E', 'X', 'S', 'N', 'A', 'P', '\0'};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "Snapshot sections must stay 8 byte aligned");
+static_assert(sizeof(SnapshotPair) % 8 == 0, "Snapshot sections must stay 8 byte aligned");
+static_assert(sizeof(SnapshotUser) % 8 == 0, "Snapshot sections must stay 8 byte aligned");
+static_assert(sizeof(SnapshotOrder) % 8 == 0, "Snapshot sections must stay 8 byte aligned");
+
+// Does [offset, offset + count * size) lie inside a file of fileSize bytes?
+bool inBounds(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize) {
+    return offset <= fileSize && count <= (fileSize - offset) / size;
+}
+
+} // namespace
+
+void writeSnapshot(const std::string& path, const SnapshotHeader& header,
+                   const std::vector<BookImage>& books, const std::vector<std::string>& users) {
+    // Lay the file out first so every offset is known up front
+    SnapshotHeader out = header;
+    std::memcpy(out.magic, kMagic, sizeof(kMagic));
+    out.version = SnapshotHeader::kVersion;
+    out.pairCount = static_cast<uint32_t>(books.size());
+    out.userCount = users.size();
+
+    uint64_t offset = sizeof(SnapshotHeader);
+    out.pairsOffset = offset;
+    offset += books.size() * sizeof(SnapshotPair);
+    out.usersOffset = offset;
+    offset += users.size() * sizeof(SnapshotUser);
+
+    std::vector<SnapshotPair> pairs(books.size());
+    for (size_t i = 0; i < books.size(); ++i) {
+        pairs[i].pairId = books[i].pairId;
+        pairs[i].tickSize = books[i].spec.tickSize;
+        pairs[i].lotSize = books[i].spec.lotSize;
+        pairs[i].journalSequence = books[i].journalSequence;
+        pairs[i].lastPrice = books[i].lastPrice;
+        pairs[i].ordersOffset = offset;
+        pairs[i].orderCount = books[i].orders.size();
+        offset += books[i].orders.size() * sizeof(SnapshotOrder);
+    }
+
+    for (size_t i = 0; i < books.size(); ++i) {
+        pairs[i].nameOffset = offset;
+        pairs[i].nameLength = static_cast<uint32_t>(books[i].tradingPair.size());
+        offset += books[i].tradingPair.size();
+    }
+
+    std::vector<SnapshotUser> userEntries(users.size());
+    for (size_t i = 0; i < users.size(); ++i) {
+        userEntries[i].nameOffset = offset;
+        userEntries[i].nameLength = users[i].size();
+        offset += users[i].size();
+    }
+    out.fileSize = offset;
+
+    std::string temporary = path + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot create snapshot " + temporary + ": " + std::strerror(errno));
+    }
+
+    bool ok = std::fwrite(&out, sizeof(out), 1, file) == 1 &&
+              std::fwrite(pairs.data(), sizeof(SnapshotPair), pairs.size(), file) == pairs.size() &&
+              std::fwrite(userEntries.data(), sizeof(SnapshotUser), userEntries.size(), file) == userEntries.size();
+
+    for (size_t i = 0; ok && i < books.size(); ++i) {
+        const auto& orders = books[i].orders;
+        ok = std::fwrite(orders.data(), sizeof(SnapshotOrder), orders.size(), file) == orders.size();
+    }
+    for (size_t i = 0; ok && i < books.size(); ++i) {
+        const auto& name = books[i].tradingPair;
+        ok = std::fwrite(name.data(), 1, name.size(), file) == name.size();
+    }
+    for (size_t i = 0; ok && i < users.size(); ++i) {
+        ok = std::fwrite(users[i].data(), 1, users[i].size(), file) == users[i].size();
+    }
+
+    ok = ok && std::fflush(file) == 0 && ::fsync(::fileno(file)) == 0;
+    ok = std::fclose(file) == 0 && ok;
+
+    // The previous snapshot stays in place until the new one is complete
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot write snapshot " + path + ": " + std::strerror(errno));
+    }
+}
+
+SnapshotFile::SnapshotFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open snapshot " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Not a snapshot file: " + path);
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map snapshot " + path + ": " + std::strerror(errno));
+    }
+
+    data_ = static_cast<const char*>(mapping);
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+
+    try {
+        validate(path);
+    } catch (...) {
+        ::munmap(mapping, size_);
+        throw;
+    }
+}
+
+SnapshotFile::~SnapshotFile() {
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+std::string SnapshotFile::pairName(size_t index) const {
+    return std::string(data_ + pair(index).nameOffset, pair(index).nameLength);
+}
+
+const SnapshotOrder* SnapshotFile::orders(size_t index) const {
+    return reinterpret_cast<const SnapshotOrder*>(data_ + pair(index).ordersOffset);
+}
+
+std::string SnapshotFile::userName(size_t index) const {
+    return std::string(data_ + users()[index].nameOffset, users()[index].nameLength);
+}
+
+void SnapshotFile::validate(const std::string& path) const {
+    const SnapshotHeader& head = header();
+
+    if (std::memcmp(head.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a snapshot file: " + path);
+    }
+    if (head.version != SnapshotHeader::kVersion) {
+        throw std::runtime_error("Unsupported snapshot version in " + path);
+    }
+
+    // Everything below is read in place, so check every section first
+    bool ok = head.fileSize == size_ &&
+              head.pairsOffset % 8 == 0 && head.usersOffset % 8 == 0 &&
+              inBounds(head.pairsOffset, head.pairCount, sizeof(SnapshotPair), size_) &&
+              inBounds(head.usersOffset, head.userCount, sizeof(SnapshotUser), size_);
+
+    for (size_t i = 0; ok && i < head.pairCount; ++i) {
+        const SnapshotPair& entry = pair(i);
+        ok = entry.ordersOffset % 8 == 0 &&
+             inBounds(entry.ordersOffset, entry.orderCount, sizeof(SnapshotOrder), size_) &&
+             inBounds(entry.nameOffset, entry.nameLength, 1, size_);
+    }
+    for (size_t i = 0; ok && i < head.userCount; ++i) {
+        ok = inBounds(users()[i].nameOffset, users()[i].nameLength, 1, size_);
+    }
+
+    if (!ok) {
+        throw std::runtime_error("Corrupt snapshot file: " + path);
+    }
+}
+
+Snapshotter::Snapshotter(const MatchingEngine& engine, const std::string& path,
+                         std::chrono::milliseconds interval)
+    : engine_(engine), path_(path), interval_(interval) {
+    thread_ = std::thread([this] { run(); });
+}
+
+Snapshotter::~Snapshotter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    thread_.join();
+}
+
+std::string Snapshotter::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+void Snapshotter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!wakeup_.wait_for(lock, interval_, [this] { return stopping_; })) {
+        lock.unlock();
+
+        std::string error;
+        try {
+            engine_.saveSnapshot(path_);
+            ++count_;
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        lock.lock();
+        lastError_ = error;
+    }
+}
+
+} // namespace DEX
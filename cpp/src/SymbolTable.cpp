@@ -0,0 +1,54 @@
+#include "../include/SymbolTable.hpp"
+#include <mutex>
+
+namespace DEX {
+
+uint32_t SymbolTable::intern(const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // Another thread may have interned it between the two locks
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(name, id);
+
+    if (onInsert_) {
+        onInsert_(id, name);
+    }
+    return id;
+}
+
+uint32_t SymbolTable::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    return it == ids_.end() ? kInvalidId : it->second;
+}
+
+const std::string& SymbolTable::name(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_[id];
+}
+
+size_t SymbolTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
+
+void SymbolTable::setInsertHook(InsertHook hook) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    onInsert_ = std::move(hook);
+}
+
+} // namespace DEX
@@ -23,7 +23,7 @@ void printMarketData(const MatchingEngine::MarketData& data) {
     }
 }
 
-void printTrades(const std::vector<Trade>& trades) {
+void printTrades(const std::vector<Trade>& trades, const PairSpec& spec) {
     if (trades.empty()) {
         std::cout << "No trades executed." << std::endl;
         return;
@@ -33,8 +33,8 @@ void printTrades(const std::vector<Trade>& trades) {
     for (const auto& trade : trades) {
         std::cout << "Trade: Buy Order #" << trade.buyOrderId
                   << " <-> Sell Order #" << trade.sellOrderId
-                  << " | Price: " << trade.price
-                  << " | Quantity: " << trade.quantity << std::endl;
+                  << " | Price: " << spec.toPrice(trade.price)
+                  << " | Quantity: " << spec.toQuantity(trade.quantity) << std::endl;
     }
 }
 
@@ -81,7 +81,7 @@ int main() {
     std::cout << "User6: SELL 1.2 ETH @ MARKET" << std::endl;
     auto trades6 = engine.submitOrder("user6", "ETH/USDT", OrderSide::SELL,
                                       OrderType::MARKET, 0.0, 1.2);
-    printTrades(trades6);
+    printTrades(trades6, engine.getOrderBook("ETH/USDT")->getSpec());
 
     // Print updated market data
     marketData = engine.getMarketData("ETH/USDT");
@@ -0,0 +1,33 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(amend_priority) {
+    MatchingEngine engine;
+    engine.addTradingPair("X", unitSpec());
+    OrderResult first = engine.submitOrder("a", "X", OrderSide::SELL, OrderType::LIMIT, 10, 5, kIgnoreTrades);
+    OrderResult second = engine.submitOrder("b", "X", OrderSide::SELL, OrderType::LIMIT, 10, 5, kIgnoreTrades);
+    std::vector<Trade> trades;
+
+    // Sizing down at the same price keeps the order's place
+    CHECK(engine.amendOrder(first.orderId, "X", 10, 4, trades));
+    trades = engine.submitOrder("c", "X", OrderSide::BUY, OrderType::LIMIT, 10, 1);
+    CHECK(trades.size() == 1 && trades[0].sellOrderId == first.orderId);
+
+    // Sizing up sends it to the back of the level
+    CHECK(engine.amendOrder(first.orderId, "X", 10, 8, trades));
+    trades = engine.submitOrder("c", "X", OrderSide::BUY, OrderType::LIMIT, 10, 1);
+    CHECK(trades.size() == 1 && trades[0].sellOrderId == second.orderId);
+
+    // A new price that crosses trades at once
+    OrderResult bid = engine.submitOrder("d", "X", OrderSide::BUY, OrderType::LIMIT, 8, 2, kIgnoreTrades);
+    trades.clear();
+    CHECK(engine.amendOrder(bid.orderId, "X", 10, 2, trades));
+    CHECK(trades.size() == 1 && trades[0].sellOrderId == second.orderId && trades[0].quantity == 2);
+
+    // Nothing left above the filled quantity cancels it
+    CHECK(engine.amendOrder(second.orderId, "X", 10, 3, trades));
+    CHECK(statusOf(engine, second.orderId, "X") == OrderStatus::CANCELLED);
+    CHECK(!engine.amendOrder(second.orderId, "X", 10, 5, trades));
+}
@@ -0,0 +1,75 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+OrderRequest request(const std::string& user, const std::string& pair, OrderSide side,
+                     double price, double quantity) {
+    return OrderRequest{user, pair, side, OrderType::LIMIT, price, quantity};
+}
+
+bool hasTrade(const std::vector<Trade>& trades, uint64_t buy, uint64_t sell) {
+    for (const Trade& trade : trades) {
+        if (trade.buyOrderId == buy && trade.sellOrderId == sell) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(batch_submit) {
+    MatchingEngine engine;
+    engine.addTradingPair("A", unitSpec());
+    engine.addTradingPair("B", unitSpec());
+    uint64_t base = engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 1, 1, kIgnoreTrades).orderId;
+
+    // IDs follow arrival order across pairs; each pair matches in arrival order
+    std::vector<OrderRequest> batch = {
+        request("alice", "A", OrderSide::BUY, 10, 1),
+        request("bob", "B", OrderSide::BUY, 5, 1),
+        request("carol", "A", OrderSide::SELL, 10, 1),
+        request("dave", "B", OrderSide::SELL, 5, 2),
+        request("erin", "B", OrderSide::BUY, 5, 1),
+    };
+    std::vector<Trade> trades;
+    CHECK(engine.submitOrders(batch, trades) == 3);
+    CHECK(trades.size() == 3);
+    CHECK(hasTrade(trades, base + 1, base + 3));
+    CHECK(hasTrade(trades, base + 2, base + 4));
+    CHECK(hasTrade(trades, base + 5, base + 4));
+
+    // Trades come out grouped by pair, in match order within each
+    size_t firstB = trades[0].buyOrderId == base + 1 ? 1 : 0;
+    CHECK(trades[firstB].buyOrderId == base + 2);
+    CHECK(trades[firstB + 1].buyOrderId == base + 5);
+
+    CHECK(statusOf(engine, base + 4, "B") == OrderStatus::FILLED);
+    CHECK(engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 1, 1, kIgnoreTrades).orderId == base + 6);
+}
+
+TEST(batch_submit_rejected) {
+    MatchingEngine engine;
+    engine.addTradingPair("A", unitSpec());
+    uint64_t base = engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 10, 1, kIgnoreTrades).orderId;
+    UserId probe = engine.internUser("probe");
+
+    // One bad request anywhere leaves the engine as it was: no order runs,
+    // no ID is used and none of the batch's users is interned
+    std::vector<OrderRequest> offGrid = {
+        request("ghost1", "A", OrderSide::SELL, 10, 1),
+        request("ghost2", "A", OrderSide::SELL, 10.5, 1),
+    };
+    std::vector<OrderRequest> unknownPair = {
+        request("ghost3", "A", OrderSide::SELL, 10, 1),
+        request("ghost4", "Z", OrderSide::SELL, 10, 1),
+    };
+    std::vector<Trade> trades;
+    CHECK_THROWS(engine.submitOrders(offGrid, trades), std::invalid_argument);
+    CHECK_THROWS(engine.submitOrders(unknownPair, trades), std::runtime_error);
+    CHECK(trades.empty());
+    CHECK(engine.getOrderBook("A")->getOrderCount() == 1);
+    CHECK(engine.internUser("probe2") == probe + 1);
+    CHECK(engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 10, 1, kIgnoreTrades).orderId == base + 1);
+}
@@ -0,0 +1,90 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(book_memory) {
+    BookMemory memory;
+    memory.arena.prefault = true;
+    memory.reserveOrders = 4096;
+
+    // The same flow trades the same way, wherever the book lives
+    MatchingEngine heap;
+    MatchingEngine arena;
+    heap.addTradingPair("A", unitSpec());
+    heap.addTradingPair("B", unitSpec());
+    arena.setBookMemory(memory);
+    arena.addTradingPair("A", unitSpec());
+    arena.addTradingPair("B", unitSpec(), memory);
+    CHECK(arena.getOrderBook("A")->getMappedBytes() > 0);
+    CHECK(heap.getOrderBook("A")->getMappedBytes() == 0);
+
+    Clock::time_point start = Clock::now() + std::chrono::hours(1);
+    tradeFlow(heap, start, 4);
+    tradeFlow(arena, start, 4);
+    CHECK(sameBooks(heap, arena));
+
+    BookMemory missing;
+    missing.arena.numaNode = BookArena::nodeCount();
+    CHECK_THROWS(arena.setBookMemory(missing), std::invalid_argument);
+}
+
+TEST(heap_fallback_counted) {
+    // Without options the arena takes aligned blocks from the heap; stats
+    // builds count those like any other allocation
+    if constexpr (!kStatsEnabled) {
+        return;
+    }
+
+    BookArena arena(BookArena::Options{});
+    uint64_t before = threadAllocations();
+    void* memory = arena.allocate(4096, 64);
+    CHECK(threadAllocations() == before + 1);
+    arena.deallocate(memory, 4096, 64);
+
+    ArenaAllocator<RestingOrder> allocator;
+    RestingOrder* orders = allocator.allocate(16);
+    CHECK(threadAllocations() == before + 2);
+    allocator.deallocate(orders, 16);
+}
+
+TEST(arena_reuse) {
+    BookArena::Options options;
+    options.prefault = true;
+    BookArena arena(options);
+
+    // A freed small block serves the next request of its size class
+    void* block = arena.allocate(1000, 64);
+    arena.deallocate(block, 1000, 64);
+    CHECK(arena.allocate(1024, 64) == block);
+    arena.deallocate(block, 1024, 64);
+
+    // An index that keeps doubling reuses the tables freed before it
+    for (int round = 0; round < 2; ++round) {
+        IdIndex<RestingOrder> index(&arena);
+        index.reserve(20000);
+    }
+    size_t mapped = arena.mappedBytes();
+    for (int round = 0; round < 8; ++round) {
+        IdIndex<RestingOrder> index(&arena);
+        index.reserve(20000);
+    }
+    CHECK(arena.mappedBytes() == mapped);
+
+    // Resizing the recent ring back and forth doesn't map anything new
+    BookMemory memory;
+    memory.arena.prefault = true;
+    MatchingEngine engine;
+    engine.setBookMemory(memory);
+    engine.addTradingPair("A", unitSpec());
+    std::shared_ptr<OrderBook> book = engine.getOrderBook("A");
+    size_t bookMapped = 0;
+    for (int round = 0; round < 12; ++round) {
+        engine.setRecentOrderCapacity(size_t(1024) << (round % 3));
+        uint64_t id = engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 10, 1,
+                                         kIgnoreTrades).orderId;
+        CHECK(engine.cancelOrder(id, "A"));
+        if (round == 2) bookMapped = book->getMappedBytes();
+    }
+    CHECK(book->getMappedBytes() == bookMapped);
+}
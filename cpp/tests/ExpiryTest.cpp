@@ -0,0 +1,65 @@
+#include "TestHarness.hpp"
+#include "../include/TimerWheel.hpp"
+#include <stdexcept>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(good_till_date) {
+    MatchingEngine engine;
+    engine.addTradingPair("X", unitSpec());
+    Clock::time_point start = Clock::now() + std::chrono::hours(1);
+
+    OrderResult soon = engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 10, 1, kIgnoreTrades,
+                                          TimeInForce::GTD, start + std::chrono::seconds(1));
+    OrderResult later = engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 11, 1, kIgnoreTrades,
+                                           TimeInForce::GTD, start + std::chrono::seconds(2));
+    OrderResult gtc = engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 12, 1, kIgnoreTrades);
+
+    CHECK(engine.expireOrders(start) == 0);
+    CHECK(engine.expireOrders(start + std::chrono::milliseconds(1500)) == 1);
+    CHECK(statusOf(engine, soon.orderId, "X") == OrderStatus::EXPIRED);
+    CHECK(statusOf(engine, later.orderId, "X") == OrderStatus::PENDING);
+
+    // A cancelled GTD order is off the wheel too
+    engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 9, 1, kIgnoreTrades, TimeInForce::GTD,
+                       start + std::chrono::seconds(2));
+    CHECK(engine.cancelOrder(engine.getTotalOrders(), "X"));
+    CHECK(engine.expireOrders(start + std::chrono::hours(24)) == 1);
+    CHECK(statusOf(engine, later.orderId, "X") == OrderStatus::EXPIRED);
+    CHECK(statusOf(engine, gtc.orderId, "X") == OrderStatus::PENDING);
+
+    CHECK_THROWS(engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 10, 1, TimeInForce::GTD,
+                                    Clock::now() - std::chrono::seconds(1)),
+                 std::invalid_argument);
+    CHECK_THROWS(engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 10, 1, TimeInForce::GTC,
+                                    Clock::now() + std::chrono::seconds(1)),
+                 std::invalid_argument);
+}
+
+TEST(timer_wheel_throw) {
+    struct Node {
+        TimerLink<Node> link;
+    };
+    struct LinkOf {
+        TimerLink<Node>& operator()(Node* node) const { return node->link; }
+    };
+
+    TimerWheel<Node, LinkOf> wheel{LinkOf{}};
+    Node nodes[5];
+    for (Node& node : nodes) {
+        wheel.schedule(&node, 5 * TimerWheel<Node, LinkOf>::kTickNanos);
+    }
+
+    // The node whose callback throws and those after it stay scheduled
+    int calls = 0;
+    CHECK_THROWS(wheel.advance(10 * TimerWheel<Node, LinkOf>::kTickNanos, [&calls](Node*) {
+                     if (++calls == 2) {
+                         throw std::runtime_error("expire failed");
+                     }
+                 }),
+                 std::runtime_error);
+    CHECK(wheel.size() == 4);
+    CHECK(wheel.advance(10 * TimerWheel<Node, LinkOf>::kTickNanos, [](Node*) {}) == 4);
+    CHECK(wheel.empty());
+}
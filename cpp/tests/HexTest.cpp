@@ -0,0 +1,102 @@
+#include "TestHarness.hpp"
+#include "keccak.h"
+#include <algorithm>
+#include <cctype>
+#include <random>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+// Plain reference codec the SIMD paths are checked against
+std::string referenceHex(const std::vector<uint8_t>& bytes, bool upper = false) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    std::string hex;
+    for (uint8_t byte : bytes) {
+        hex += digits[byte >> 4];
+        hex += digits[byte & 15];
+    }
+    return hex;
+}
+
+std::vector<uint8_t> randomBytes(std::mt19937& random, size_t len) {
+    std::vector<uint8_t> bytes(len);
+    for (uint8_t& byte : bytes) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(hex_codec) {
+    // Up to 100 bytes reaches the scalar code (under 16 bytes), SSSE3 (16
+    // to 31) and AVX2 with a scalar tail (32 and up), as the CPU allows
+    std::mt19937 random(25);
+    bool encoded = true;
+    bool decoded = true;
+    for (size_t len = 0; len <= 100; ++len) {
+        std::vector<uint8_t> bytes = randomBytes(random, len);
+        std::string expected = referenceHex(bytes);
+
+        std::vector<char> hex(len * 2 + 1, 'x');
+        bytes_to_hex(bytes.data(), len, hex.data());
+        encoded &= std::string(hex.data()) == expected;
+
+        // Upper, lower and mixed case all decode
+        std::string mixed = referenceHex(bytes, true);
+        for (size_t i = 0; i < mixed.size(); i += 3) {
+            mixed[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(mixed[i])));
+        }
+        for (const std::string& text : {expected, referenceHex(bytes, true), mixed}) {
+            std::vector<uint8_t> out(len + 1, 0xEE);
+            decoded &= hex_to_bytes(text.c_str(), out.data(), len) == 0 &&
+                       std::equal(bytes.begin(), bytes.end(), out.begin()) && out[len] == 0xEE;
+            decoded &= hex_decode(text.data(), text.size(), out.data()) == 0 &&
+                       std::equal(bytes.begin(), bytes.end(), out.begin());
+        }
+
+        // In place, on a buffer with room for the characters
+        std::vector<uint8_t> buffer(len * 2);
+        std::copy(bytes.begin(), bytes.end(), buffer.begin());
+        bytes_to_hex_inplace(buffer.data(), len);
+        encoded &= std::string(buffer.begin(), buffer.end()) == expected;
+        std::string text = mixed;
+        decoded &= hex_to_bytes_inplace(&text[0], text.size()) == 0 &&
+                   std::equal(bytes.begin(), bytes.end(), reinterpret_cast<const uint8_t*>(text.data()));
+    }
+    CHECK(encoded);
+    CHECK(decoded);
+}
+
+TEST(hex_invalid) {
+    // A bad character is caught wherever it falls, in every code path
+    const char invalid[] = {'g', 'G', 'x', '/', ':', '@', '`', ' ', '\x80', '\xff'};
+    std::mt19937 random(26);
+    bool rejected = true;
+    for (size_t len : {size_t(1), size_t(15), size_t(16), size_t(31), size_t(32), size_t(33), size_t(64), size_t(100)}) {
+        std::string good = referenceHex(randomBytes(random, len));
+        std::vector<uint8_t> out(len);
+        for (size_t position = 0; position < good.size(); ++position) {
+            for (char bad : invalid) {
+                std::string text = good;
+                text[position] = bad;
+                rejected &= hex_decode(text.data(), text.size(), out.data()) == -1;
+                rejected &= hex_to_bytes(text.c_str(), out.data(), len) == -1;
+                rejected &= hex_to_bytes_inplace(&text[0], text.size()) == -1;
+            }
+        }
+    }
+    CHECK(rejected);
+
+    // Odd lengths, a "0x" prefix and the wrong length are errors too
+    uint8_t out[4];
+    char odd[] = "abc";
+    CHECK(hex_decode(odd, 3, out) == -1);
+    CHECK(hex_to_bytes_inplace(odd, 3) == -1);
+    CHECK(hex_to_bytes("0xab", out, 1) == -1);
+    CHECK(hex_to_bytes("abcd", out, 1) == -1);
+    CHECK(hex_to_bytes("ab", out, 2) == -1);
+    CHECK(hex_to_bytes("", out, 0) == 0);
+}
@@ -0,0 +1,89 @@
+#include "TestHarness.hpp"
+#include <random>
+#include <unordered_map>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+// Home slot of an ID in a table of kMinCapacity slots, as IdIndex hashes it
+size_t homeOf(uint64_t id) {
+    return static_cast<size_t>((id * 0x9E3779B97F4A7C15ull) >> (64 - 10));
+}
+
+// IDs that hash into [first, first + width) of a kMinCapacity table,
+// wrapping past the end
+std::vector<uint64_t> clusteredIds(size_t first, size_t width, size_t count) {
+    std::vector<uint64_t> ids;
+    for (uint64_t id = 1; ids.size() < count; ++id) {
+        if (((homeOf(id) - first) & (IdIndex<int>::kMinCapacity - 1)) < width) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+bool matches(const IdIndex<int>& index, const std::unordered_map<uint64_t, int*>& reference,
+             const std::vector<uint64_t>& ids) {
+    if (index.size() != reference.size()) return false;
+    for (uint64_t id : ids) {
+        auto it = reference.find(id);
+        if (index.find(id) != (it == reference.end() ? nullptr : it->second)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(id_index_erase) {
+    static_assert(IdIndex<int>::kMinCapacity == 1024, "homeOf assumes the minimum table");
+    std::vector<int> targets(64);
+
+    // Dense runs of colliding IDs, one of them wrapping past the last slot,
+    // stay within the minimum table so every erase shifts a real cluster
+    for (size_t first : {size_t(100), size_t(1020)}) {
+        std::vector<uint64_t> ids = clusteredIds(first, 4, 48);
+        IdIndex<int> index;
+        std::unordered_map<uint64_t, int*> reference;
+        std::mt19937 random(static_cast<uint32_t>(first));
+
+        for (int step = 0; step < 5000; ++step) {
+            uint64_t id = ids[random() % ids.size()];
+            if (random() % 2) {
+                int* target = &targets[random() % targets.size()];
+                CHECK(index.insert(id, target) == reference.emplace(id, target).second);
+            } else {
+                CHECK(index.erase(id) == (reference.erase(id) == 1));
+            }
+            if (step % 97 == 0) CHECK(matches(index, reference, ids));
+        }
+        CHECK(matches(index, reference, ids));
+        CHECK(index.capacity() == IdIndex<int>::kMinCapacity);
+
+        for (uint64_t id : ids) {
+            index.erase(id);
+        }
+        CHECK(index.empty());
+        for (uint64_t id : ids) {
+            CHECK(!index.contains(id));
+        }
+    }
+
+    // Growth keeps every entry reachable
+    IdIndex<int> index;
+    for (uint64_t id = 1; id <= 5000; ++id) {
+        CHECK(index.insert(id, &targets[id % targets.size()]));
+    }
+    CHECK(index.capacity() > IdIndex<int>::kMinCapacity);
+    CHECK(!index.insert(42, &targets[0]));
+    for (uint64_t id = 1; id <= 5000; id += 2) {
+        CHECK(index.erase(id));
+    }
+    bool found = true;
+    for (uint64_t id = 1; id <= 5000; ++id) {
+        found &= (index.find(id) != nullptr) == (id % 2 == 0);
+    }
+    CHECK(found);
+    CHECK(index.size() == 2500);
+}
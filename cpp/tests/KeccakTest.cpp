@@ -0,0 +1,158 @@
+#include "TestHarness.hpp"
+#include "keccak.h"
+#include <algorithm>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+std::string toHex(const uint8_t* bytes, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < len; ++i) {
+        hex += digits[bytes[i] >> 4];
+        hex += digits[bytes[i] & 15];
+    }
+    return hex;
+}
+
+std::string digestOf(const uint8_t* input, size_t len) {
+    uint8_t digest[KECCAK256_HASH_SIZE];
+    keccak256(input, len, digest);
+    return toHex(digest, sizeof digest);
+}
+
+std::string digestOf(const std::string& input) {
+    return digestOf(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+}
+
+// Bytes i % 251, so no block repeats the one before it
+std::vector<uint8_t> pattern(size_t len, size_t offset = 0) {
+    std::vector<uint8_t> bytes(len);
+    for (size_t i = 0; i < len; ++i) {
+        bytes[i] = static_cast<uint8_t>((i + offset) % 251);
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(keccak256) {
+    // Ethereum's Keccak-256 (original padding, not SHA3-256)
+    CHECK(digestOf("") == "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470");
+    CHECK(digestOf("abc") == "4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45");
+    CHECK(digestOf("test") == "9c22ff5f21f0b81b113e63f7db6da94fedef11b2119b4088b89664fb9a3cb658");
+    CHECK(digestOf("The quick brown fox jumps over the lazy dog") ==
+          "4d741b6f1eb29cb2a9b9911c82f56fa8d73b04959d3d9d222895df6c0b28aa15");
+
+    // Either side of the 136-byte rate, and several blocks
+    struct Vector {
+        size_t len;
+        const char* digest;
+    };
+    const Vector vectors[] = {
+        {135, "cbdfd9dee5faad3818d6b06f95a219fd290b0e1706f6a82e5a595b9ce9faca62"},
+        {136, "7ce759f1ab7f9ce437719970c26b0a66ff11fe3e38e17df89cf5d29c7d7f807e"},
+        {137, "ac73d4fae68b8453f764007c1a20ce95994187861f0c3227a3a8e99a73a3b1db"},
+        {272, "8e2476e65823b24d96ebe239f2c1534cdf763e689e2410c3b1cb0c74e6177bfc"},
+        {1000, "af692982e84a5a9688359025660a7857cd28ee7c8d867cfa1677baf2e6d1f63b"},
+    };
+    for (const Vector& vector : vectors) {
+        std::vector<uint8_t> input = pattern(vector.len);
+        CHECK(digestOf(input.data(), input.size()) == vector.digest);
+    }
+
+    // Keccak-f[1600] of the all-zero state
+    uint64_t state[25] = {};
+    keccak_f1600(state);
+    CHECK(state[0] == 0xF1258F7940E1DDE7ull);
+    CHECK(state[1] == 0x84D5CCF933C0478Aull);
+    CHECK(state[24] == 0xEAF1FF7B5CECA249ull);
+}
+
+TEST(keccak256_batch) {
+    int width = keccak256_batch_width();
+    CHECK(width == 1 || width == 4 || width == 8);
+
+    // Every count up to 20 runs full AVX-512 groups of 8, then AVX2 groups
+    // of 4, then single messages, as far as the CPU supports them. Each
+    // lane must match the scalar hash, with equal and mixed lengths in a
+    // group and lengths around the rate.
+    const size_t lengths[] = {0, 1, 31, 32, 135, 136, 137, 200, 271, 272, 273, 1000};
+    const size_t kinds = sizeof lengths / sizeof lengths[0];
+    for (int mixed = 0; mixed < 2; ++mixed) {
+        for (size_t count = 1; count <= 20; ++count) {
+            std::vector<std::vector<uint8_t>> messages;
+            std::vector<const uint8_t*> inputs;
+            std::vector<size_t> lens;
+            for (size_t i = 0; i < count; ++i) {
+                size_t len = lengths[mixed ? (i * 5 + count) % kinds : count % kinds];
+                messages.push_back(pattern(len, i));
+                inputs.push_back(messages.back().data());
+                lens.push_back(len);
+            }
+
+            std::vector<uint8_t> outputs(count * KECCAK256_HASH_SIZE);
+            keccak256_batch(inputs.data(), lens.data(), count, outputs.data());
+            bool same = true;
+            for (size_t i = 0; i < count; ++i) {
+                same &= toHex(&outputs[i * KECCAK256_HASH_SIZE], KECCAK256_HASH_SIZE) ==
+                        digestOf(messages[i].data(), messages[i].size());
+            }
+            CHECK(same);
+        }
+    }
+
+    // An empty batch writes nothing
+    uint8_t untouched = 0xAB;
+    keccak256_batch(nullptr, nullptr, 0, &untouched);
+    CHECK(untouched == 0xAB);
+}
+
+TEST(keccak256_incremental) {
+    // Any split of the message gives the one-shot digest, including empty
+    // updates and splits on and around block boundaries
+    std::vector<uint8_t> input = pattern(300);
+    bool same = true;
+    for (size_t first = 0; first <= input.size(); ++first) {
+        for (size_t second : {size_t(0), size_t(1), size_t(135), size_t(136), size_t(137)}) {
+            size_t middle = std::min(second, input.size() - first);
+            keccak256_ctx ctx;
+            keccak256_init(&ctx);
+            keccak256_update(&ctx, input.data(), first);
+            keccak256_update(&ctx, input.data() + first, middle);
+            keccak256_update(&ctx, input.data() + first + middle, input.size() - first - middle);
+            uint8_t digest[KECCAK256_HASH_SIZE];
+            keccak256_final(&ctx, digest);
+            same &= toHex(digest, sizeof digest) == digestOf(input.data(), input.size());
+        }
+    }
+    CHECK(same);
+
+    // Byte at a time
+    keccak256_ctx ctx;
+    keccak256_init(&ctx);
+    for (uint8_t byte : input) {
+        keccak256_update(&ctx, &byte, 1);
+    }
+    uint8_t digest[KECCAK256_HASH_SIZE];
+    keccak256_final(&ctx, digest);
+    CHECK(toHex(digest, sizeof digest) == digestOf(input.data(), input.size()));
+
+    // A copied context forks the stream: the prefix's digest, and the rest
+    keccak256_init(&ctx);
+    keccak256_update(&ctx, input.data(), 150);
+    keccak256_ctx fork = ctx;
+    keccak256_final(&fork, digest);
+    CHECK(toHex(digest, sizeof digest) == digestOf(input.data(), 150));
+    keccak256_update(&ctx, input.data() + 150, 150);
+    keccak256_final(&ctx, digest);
+    CHECK(toHex(digest, sizeof digest) == digestOf(input.data(), input.size()));
+
+    // Reinitialized, a context starts over
+    keccak256_init(&ctx);
+    keccak256_update(&ctx, reinterpret_cast<const uint8_t*>("abc"), 3);
+    keccak256_final(&ctx, digest);
+    CHECK(toHex(digest, sizeof digest) == digestOf("abc"));
+}
@@ -0,0 +1,92 @@
+#include "TestHarness.hpp"
+#include <map>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(l2_feed) {
+    MatchingEngine engine;
+    engine.addTradingPair("X", unitSpec());
+    engine.submitOrder("u", "X", OrderSide::BUY, OrderType::LIMIT, 99, 5);
+
+    L2Feed::Options options;
+    options.capacity = 256;
+    options.snapshotInterval = 32;
+    engine.enableL2Feed(options);
+    const L2Feed* feed = engine.getL2Feed("X");
+    CHECK(feed != nullptr);
+    if (!feed) {
+        return;
+    }
+
+    // A subscriber's view: its snapshot with every update applied
+    struct View {
+        std::map<Price, DepthLevel> bids, asks;
+        uint64_t sequence = 0;
+
+        void load(const L2Snapshot& snapshot) {
+            bids.clear();
+            asks.clear();
+            for (const DepthLevel& level : snapshot.bids) bids[level.price] = level;
+            for (const DepthLevel& level : snapshot.asks) asks[level.price] = level;
+            sequence = snapshot.sequence;
+        }
+
+        bool apply(const L2Update& update) {
+            auto& levels = update.side == OrderSide::BUY ? bids : asks;
+            if (update.quantity == 0) {
+                levels.erase(update.price);
+            } else {
+                levels[update.price] = DepthLevel{update.price, update.quantity, update.orderCount};
+            }
+            return update.sequence == ++sequence;
+        }
+
+        bool matches(const OrderBook& book) const {
+            Depth bidLevels, askLevels;
+            for (auto it = bids.rbegin(); it != bids.rend(); ++it) bidLevels.push_back(it->second);
+            for (const auto& entry : asks) askLevels.push_back(entry.second);
+            return sameDepth(bidLevels, bidDepth(book)) && sameDepth(askLevels, askDepth(book));
+        }
+    };
+
+    const OrderBook& book = *engine.getOrderBook("X");
+    L2Subscriber subscriber(*feed);
+    L2Subscriber lagging(*feed);
+    View view;
+    view.load(subscriber.snapshot());
+    CHECK(view.matches(book));
+
+    std::vector<L2Update> updates(64);
+    std::vector<uint64_t> ids;
+    for (int step = 0; step < 2000; ++step) {
+        OrderSide side = step % 2 ? OrderSide::BUY : OrderSide::SELL;
+        if (step % 5 == 4 && !ids.empty()) {
+            engine.cancelOrder(ids[static_cast<size_t>(step) % ids.size()], "X");
+        } else {
+            double price = 100.0 + (step * 7) % 21 - 10 + (side == OrderSide::BUY ? -2 : 2);
+            ids.push_back(engine.submitOrder("u", "X", side, OrderType::LIMIT, price, 1.0 + step % 7,
+                                             kIgnoreTrades).orderId);
+        }
+
+        size_t count = subscriber.poll(updates.data(), updates.size());
+        CHECK(!subscriber.needsResync());
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(view.apply(updates[i]));
+        }
+        CHECK(view.matches(book));
+    }
+
+    // Fell more than the ring behind: resync from the latest snapshot
+    lagging.poll(updates.data(), 1);
+    CHECK(lagging.needsResync());
+    View resynced;
+    resynced.load(lagging.resync());
+    while (size_t count = lagging.poll(updates.data(), updates.size())) {
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(resynced.apply(updates[i]));
+        }
+    }
+    CHECK(!lagging.needsResync());
+    CHECK(resynced.matches(book));
+}
@@ -0,0 +1,39 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(time_in_force) {
+    MatchingEngine engine;
+    engine.addTradingPair("X", unitSpec());
+    engine.submitOrder("maker", "X", OrderSide::SELL, OrderType::LIMIT, 10, 1);
+    engine.submitOrder("maker", "X", OrderSide::SELL, OrderType::LIMIT, 11, 1);
+
+    // FOK larger than the book, or than the book within its price, does nothing
+    OrderResult result = engine.submitOrder("taker", "X", OrderSide::BUY, OrderType::LIMIT, 11, 3,
+                                            kIgnoreTrades, TimeInForce::FOK);
+    CHECK(result.status == OrderStatus::CANCELLED);
+    result = engine.submitOrder("taker", "X", OrderSide::BUY, OrderType::LIMIT, 10, 2,
+                                kIgnoreTrades, TimeInForce::FOK);
+    CHECK(result.status == OrderStatus::CANCELLED);
+    CHECK(engine.getMarketData("X").bestAsk == 10);
+
+    // Post-only is rejected if it would cross, rests otherwise
+    result = engine.submitOrder("taker", "X", OrderSide::BUY, OrderType::POST_ONLY, 10, 1, kIgnoreTrades);
+    CHECK(result.status == OrderStatus::REJECTED);
+    result = engine.submitOrder("taker", "X", OrderSide::BUY, OrderType::POST_ONLY, 9, 1, kIgnoreTrades);
+    CHECK(result.status == OrderStatus::PENDING);
+
+    // IOC takes what it can and never rests
+    std::vector<Trade> trades = engine.submitOrder("ioc", "X", OrderSide::BUY, OrderType::LIMIT, 10, 2,
+                                                   TimeInForce::IOC);
+    CHECK(trades.size() == 1);
+    CHECK(engine.getMarketData("X").bestBid == 9);
+    CHECK(engine.getUserOrders("ioc").empty());
+
+    // FOK that fits fills completely
+    result = engine.submitOrder("fok", "X", OrderSide::BUY, OrderType::LIMIT, 11, 1, kIgnoreTrades,
+                                TimeInForce::FOK);
+    CHECK(result.status == OrderStatus::FILLED);
+    CHECK(engine.getUserOrders("fok").empty());
+}
@@ -0,0 +1,48 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(pair_ids) {
+    MatchingEngine engine;
+    CHECK(engine.getPairId("P0") == MatchingEngine::kInvalidPairId);
+    PairId first = 0;
+    CHECK(engine.getOrderBook(first) == nullptr);
+
+    // IDs are dense in order of addition, across more than one page of books
+    const PairId count = 600;
+    for (PairId id = 0; id < count; ++id) {
+        CHECK(engine.addTradingPair("P" + std::to_string(id), unitSpec()) == id);
+    }
+    CHECK(engine.getTradingPairCount() == count);
+    CHECK(engine.addTradingPair("P7", unitSpec()) == MatchingEngine::kInvalidPairId);
+    CHECK(engine.getTradingPairCount() == count);
+
+    bool consistent = true;
+    for (PairId id = 0; id < count; ++id) {
+        std::string name = "P" + std::to_string(id);
+        OrderBook* book = engine.getOrderBook(id);
+        consistent &= engine.getPairId(name) == id && book == engine.getOrderBook(name).get() &&
+                      book->getTradingPair() == name;
+    }
+    CHECK(consistent);
+    CHECK(engine.getOrderBook(count) == nullptr);
+    CHECK(engine.getOrderBook(MatchingEngine::kInvalidPairId) == nullptr);
+    CHECK(engine.getPairId("missing") == MatchingEngine::kInvalidPairId);
+
+    // The ID overloads reach the same book as the name ones
+    PairId pair = engine.getPairId("P300");
+    UserId alice = engine.internUser("alice");
+    OrderResult result = engine.submitOrder(pair, alice, OrderSide::BUY, OrderType::LIMIT, 10, 1, kIgnoreTrades);
+    CHECK(result.status == OrderStatus::PENDING);
+    CHECK(engine.getOrderBook("P300")->getOrderCount() == 1);
+    std::vector<Order> orders = engine.getUserOrders(alice, pair);
+    CHECK(orders.size() == 1 && orders[0].pairId == pair);
+    CHECK(!engine.cancelOrder(result.orderId, engine.getPairId("P301")));
+    CHECK(engine.cancelOrder(result.orderId, pair));
+
+    CHECK(!engine.cancelOrder(result.orderId, MatchingEngine::kInvalidPairId));
+    CHECK_THROWS(engine.submitOrder(MatchingEngine::kInvalidPairId, alice, OrderSide::BUY, OrderType::LIMIT,
+                                    10, 1, kIgnoreTrades),
+                 std::runtime_error);
+}
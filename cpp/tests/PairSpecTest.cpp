@@ -0,0 +1,49 @@
+#include "TestHarness.hpp"
+#include <cmath>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(tick_lot_grid) {
+    PairSpec spec;   // 0.01 ticks, 0.0001 lots
+
+    // Binary floating point noise rounds to the nearest unit
+    CHECK(spec.toTicks(123.45) == 12345);
+    CHECK(spec.toTicks(0.1 + 0.2) == 30);
+    CHECK(spec.toLots(0.0003) == 3);
+    CHECK(spec.toLots(1.0) == 10000);
+    CHECK(std::fabs(spec.toPrice(12345) - 123.45) < 1e-9);
+    CHECK(std::fabs(spec.toQuantity(3) - 0.0003) < 1e-12);
+
+    // Genuinely off-grid or out of range values are rejected
+    CHECK_THROWS(spec.toTicks(1.005), std::invalid_argument);
+    CHECK_THROWS(spec.toLots(0.00015), std::invalid_argument);
+    CHECK_THROWS(spec.toTicks(1e30), std::invalid_argument);
+    CHECK_THROWS(spec.toTicks(std::nan("")), std::invalid_argument);
+
+    PairSpec coarse{0.5, 10};
+    CHECK(coarse.toTicks(2.5) == 5);
+    CHECK(coarse.toLots(30) == 3);
+    CHECK_THROWS(coarse.toTicks(2.25), std::invalid_argument);
+    CHECK_THROWS(coarse.toLots(15), std::invalid_argument);
+
+    MatchingEngine engine;
+    CHECK_THROWS(engine.addTradingPair("BAD", PairSpec{0, 1}), std::invalid_argument);
+    CHECK_THROWS(engine.addTradingPair("BAD", PairSpec{1, -1}), std::invalid_argument);
+
+    // Orders are priced in ticks and lots of their pair, and off-grid ones
+    // never reach the book
+    engine.addTradingPair("X", coarse);
+    OrderResult result = engine.submitOrder("alice", "X", OrderSide::BUY, OrderType::LIMIT, 2.5, 30, kIgnoreTrades);
+    Order order(0, 0, 0, OrderSide::BUY, OrderType::LIMIT, 0, 0);
+    CHECK(engine.getOrder(result.orderId, "X", order));
+    CHECK(order.price == 5 && order.quantity == 3);
+
+    CHECK_THROWS(engine.submitOrder("alice", "X", OrderSide::BUY, OrderType::LIMIT, 2.25, 30, kIgnoreTrades),
+                 std::invalid_argument);
+    CHECK_THROWS(engine.submitOrder("alice", "X", OrderSide::BUY, OrderType::LIMIT, 2.5, 15, kIgnoreTrades),
+                 std::invalid_argument);
+    CHECK_THROWS(engine.submitOrder("alice", "X", OrderSide::BUY, OrderType::LIMIT, 2.5, 0, kIgnoreTrades),
+                 std::invalid_argument);
+    CHECK(engine.getOrderBook("X")->getOrderCount() == 1);
+}
@@ -0,0 +1,58 @@
+#include "TestHarness.hpp"
+#include "../include/PriceLadder.hpp"
+#include <deque>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+// Walk a band of levels through several window widths towards worse
+// prices, one level at a time, as a trending market does
+template <OrderSide S>
+void checkLadderDrift() {
+    constexpr size_t kWindow = 64;
+    constexpr int64_t kBand = 10;
+    const int64_t worse = S == OrderSide::BUY ? -1 : 1;
+
+    PriceLadder<S> ladder(kWindow);
+    std::deque<RestingOrder> orders;
+    auto add = [&](Price price) {
+        orders.emplace_back(orders.size() + 1, 0, S, OrderType::LIMIT, TimeInForce::GTC, price, 1);
+        ladder.insert(price).pushBack(&orders.back());
+    };
+
+    Price best = 10000;
+    for (int64_t i = 0; i < kBand; ++i) {
+        add(best + i * worse);
+    }
+    for (size_t step = 0; step < 5 * kWindow; ++step) {
+        PriceLevel* level = ladder.best();
+        CHECK(level && level->price == best);
+        if (!level) {
+            return;
+        }
+        level->popFront();
+        ladder.erase(best);
+        best += worse;
+        add(best + (kBand - 1) * worse);
+
+        CHECK(ladder.size() == static_cast<size_t>(kBand));
+        CHECK(ladder.windowLevels() == ladder.size());
+    }
+
+    Price expected = best;
+    ladder.forEach([&](const PriceLevel& level) {
+        CHECK(level.price == expected);
+        expected += worse;
+        return true;
+    });
+    CHECK(expected == best + kBand * worse);
+}
+
+} // namespace
+
+TEST(ladder_drift) {
+    checkLadderDrift<OrderSide::BUY>();
+    checkLadderDrift<OrderSide::SELL>();
+}
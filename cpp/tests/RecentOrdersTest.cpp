@@ -0,0 +1,65 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+OrderRecord record(uint64_t id, OrderStatus status) {
+    OrderRecord value{};
+    value.id = id;
+    value.status = status;
+    return value;
+}
+
+bool hasRecord(const RecentOrders& recent, uint64_t id, OrderStatus status) {
+    const OrderRecord* found = recent.find(id);
+    return found && found->id == id && found->status == status;
+}
+
+} // namespace
+
+TEST(recent_orders) {
+    // Once full, each record overwrites the oldest
+    RecentOrders recent(3);
+    CHECK(!recent.find(1));
+    for (uint64_t id = 1; id <= 5; ++id) {
+        recent.push(record(id, OrderStatus::FILLED));
+    }
+    CHECK(recent.size() == 3);
+    CHECK(!recent.find(1) && !recent.find(2));
+    CHECK(hasRecord(recent, 3, OrderStatus::FILLED) && hasRecord(recent, 5, OrderStatus::FILLED));
+
+    // A reused ID points at its newest record, and evicting the older one
+    // leaves it in place
+    recent.push(record(4, OrderStatus::CANCELLED));   // Evicts 3
+    CHECK(hasRecord(recent, 4, OrderStatus::CANCELLED));
+    recent.push(record(6, OrderStatus::FILLED));      // Evicts the first 4
+    CHECK(hasRecord(recent, 4, OrderStatus::CANCELLED));
+    recent.push(record(7, OrderStatus::FILLED));      // Evicts 5
+    recent.push(record(8, OrderStatus::FILLED));      // Evicts the second 4
+    CHECK(!recent.find(4) && !recent.find(5));
+    CHECK(hasRecord(recent, 6, OrderStatus::FILLED) && hasRecord(recent, 8, OrderStatus::FILLED));
+
+    // Resizing drops every record; capacity 0 keeps none
+    recent.setCapacity(2);
+    CHECK(recent.size() == 0 && !recent.find(8));
+    recent.push(record(9, OrderStatus::EXPIRED));
+    CHECK(hasRecord(recent, 9, OrderStatus::EXPIRED));
+    recent.setCapacity(0);
+    recent.push(record(10, OrderStatus::FILLED));
+    CHECK(recent.size() == 0 && !recent.find(9) && !recent.find(10));
+
+    // Through the engine: retired orders stay queryable until overwritten
+    MatchingEngine engine;
+    engine.setRecentOrderCapacity(2);
+    engine.addTradingPair("A", unitSpec());
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 3; ++i) {
+        ids.push_back(engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 10, 1, kIgnoreTrades).orderId);
+        CHECK(engine.cancelOrder(ids.back(), "A"));
+    }
+    Order order(0, 0, 0, OrderSide::BUY, OrderType::LIMIT, 0, 0);
+    CHECK(!engine.getOrder(ids[0], "A", order));
+    CHECK(engine.getOrder(ids[2], "A", order) && order.status == OrderStatus::CANCELLED);
+}
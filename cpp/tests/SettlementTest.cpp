@@ -0,0 +1,50 @@
+#include "TestHarness.hpp"
+#include <stdexcept>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(merkle_settlement) {
+    std::vector<SettlementBatch> batches;
+    std::vector<Trade> trades;
+    {
+        Settlement::Options options;
+        options.maxTrades = 7;
+        // Batches are handed over on the settlement thread; flush() waits for them
+        Settlement settlement([&batches](const SettlementBatch& batch) { batches.push_back(batch); }, options);
+        MatchingEngine engine;
+        engine.addTradingPair("X", unitSpec());
+        engine.attachSettlement(&settlement);
+        for (int i = 0; i < 100; ++i) {
+            OrderSide side = i % 2 ? OrderSide::BUY : OrderSide::SELL;
+            std::vector<Trade> fills = engine.submitOrder("u", "X", side, OrderType::LIMIT, 100.0 + i % 3, 1);
+            trades.insert(trades.end(), fills.begin(), fills.end());
+        }
+        settlement.flush();
+    }
+
+    size_t settled = 0;
+    uint64_t sequence = 0;
+    for (const SettlementBatch& batch : batches) {
+        CHECK(batch.sequence == ++sequence);
+        CHECK(batch.trades.size() <= 7);
+        for (size_t i = 0; i < batch.trades.size(); ++i) {
+            const SettledTrade& trade = batch.trades[i];
+            CHECK(trade.sequence == ++settled);
+            CHECK(trade.trade.buyOrderId == trades[settled - 1].buyOrderId);
+
+            Hash256 leaf = SettlementBatch::leafHash(trade);
+            CHECK(leaf == batch.levels[0][i]);
+            std::vector<Hash256> proof = batch.proof(i);
+            CHECK(SettlementBatch::verify(leaf, proof, batch.root()));
+            leaf[0] ^= 1;
+            CHECK(!SettlementBatch::verify(leaf, proof, batch.root()));
+        }
+    }
+    CHECK(settled == trades.size());
+
+    // A failing handler stops the stage and surfaces from flush
+    Settlement failing([](const SettlementBatch&) { throw std::runtime_error("chain unavailable"); });
+    failing.add(0, Trade{1, 2, 3, 4, Clock::now()});
+    CHECK_THROWS(failing.flush(), std::runtime_error);
+}
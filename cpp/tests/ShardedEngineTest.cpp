@@ -0,0 +1,53 @@
+#include "TestHarness.hpp"
+#include "../include/ShardedEngine.hpp"
+#include <future>
+#include <stdexcept>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(sharded_engine) {
+    ShardedEngine::Options options;
+    options.shardCount = 2;
+    options.pinThreads = false;
+    ShardedEngine engine(options);
+    engine.addTradingPair("X", unitSpec());
+    engine.addTradingPair("Y", unitSpec());
+    engine.start();
+
+    // The future carries the order's ID and status, so it can be cancelled
+    SubmitResult resting = engine.submitOrder("a", "X", OrderSide::SELL, OrderType::LIMIT, 10, 5).get();
+    CHECK(resting.order.status == OrderStatus::PENDING);
+    CHECK(resting.trades.empty());
+
+    SubmitResult taker = engine.submitOrder("b", "X", OrderSide::BUY, OrderType::LIMIT, 10, 2).get();
+    CHECK(taker.order.status == OrderStatus::FILLED);
+    CHECK(taker.trades.size() == 1 && taker.trades[0].sellOrderId == resting.order.orderId);
+
+    SubmitResult refused = engine.submitOrder("b", "X", OrderSide::BUY, OrderType::POST_ONLY, 10, 1).get();
+    CHECK(refused.order.status == OrderStatus::REJECTED);
+
+    CHECK(engine.cancelOrder(resting.order.orderId, "X").get());
+    CHECK(!engine.cancelOrder(resting.order.orderId, "X").get());
+
+    // So does the callback
+    std::promise<SubmitResult> delivered;
+    engine.submitOrder("a", "Y", OrderSide::BUY, OrderType::LIMIT, 7, 1,
+                       [&delivered](SubmitResult result, std::exception_ptr error) {
+                           if (error) {
+                               delivered.set_exception(error);
+                           } else {
+                               delivered.set_value(std::move(result));
+                           }
+                       });
+    SubmitResult callback = delivered.get_future().get();
+    CHECK(callback.order.status == OrderStatus::PENDING);
+    CHECK(engine.cancelOrder(callback.order.orderId, "Y").get());
+
+    // Off the tick grid: thrown on the shard thread, surfaced by the future
+    std::future<SubmitResult> invalid = engine.submitOrder("a", "X", OrderSide::BUY, OrderType::LIMIT, 10.5, 1);
+    CHECK_THROWS(invalid.get(), std::invalid_argument);
+
+    engine.stop();
+    CHECK(engine.getUnpinnedShards() == 0);
+}
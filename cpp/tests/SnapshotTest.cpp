@@ -0,0 +1,40 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(snapshot) {
+    TempFile journalFile("snapshot.jrnl");
+    TempFile snapshotFile("snapshot.snap");
+    Clock::time_point start = Clock::now() + std::chrono::hours(1);
+    MatchingEngine live;
+    {
+        Journal::Options options;
+        options.sync = false;
+        Journal journal(journalFile.path, options);
+        live.attachJournal(&journal);
+        live.addTradingPair("A", unitSpec());
+        live.addTradingPair("B", unitSpec());
+        tradeFlow(live, start, 2);
+        live.saveSnapshot(snapshotFile.path);
+        tradeFlow(live, start + std::chrono::minutes(1), 3);
+        journal.flush();
+        live.attachJournal(nullptr);
+    }
+
+    // Snapshot plus the journal's tail comes back to the live books
+    MatchingEngine restored;
+    restored.loadSnapshot(snapshotFile.path);
+    restored.replayJournal(journalFile.path);
+    CHECK(sameBooks(live, restored));
+    CHECK(restored.getTotalOrders() == live.getTotalOrders());
+
+    // and keeps trading the same way
+    for (int i = 0; i < 200; ++i) {
+        OrderSide side = i % 2 ? OrderSide::BUY : OrderSide::SELL;
+        double price = 990.0 + i % 20;
+        std::vector<Trade> a = live.submitOrder("z", "A", side, OrderType::LIMIT, price, 5);
+        std::vector<Trade> b = restored.submitOrder("z", "A", side, OrderType::LIMIT, price, 5);
+        CHECK(sameTrades(a, b));
+    }
+}
@@ -0,0 +1,27 @@
+#include "TestHarness.hpp"
+
+using namespace DEX;
+using namespace DEX::tests;
+
+TEST(stop_cascade) {
+    MatchingEngine engine;
+    engine.addTradingPair("X", unitSpec());
+    engine.submitOrder("maker", "X", OrderSide::SELL, OrderType::LIMIT, 100, 1);
+    engine.submitOrder("maker", "X", OrderSide::SELL, OrderType::LIMIT, 101, 1);
+    engine.submitOrder("maker", "X", OrderSide::SELL, OrderType::LIMIT, 102, 5);
+
+    // Nothing has traded yet, so both wait
+    engine.submitStopOrder("stops", "X", OrderSide::BUY, OrderType::STOP, 100, 0, 1);
+    engine.submitStopOrder("stops", "X", OrderSide::BUY, OrderType::STOP_LIMIT, 101, 102, 2);
+    CHECK(engine.getOrderBook("X")->getOrderCount() == 5);
+
+    // The print at 100 fires the first, whose print at 101 fires the second
+    std::vector<Trade> trades = engine.submitOrder("taker", "X", OrderSide::BUY, OrderType::MARKET, 0, 1);
+    CHECK(trades.size() == 3);
+    if (trades.size() == 3) {
+        CHECK(trades[0].price == 100 && trades[1].price == 101 && trades[2].price == 102);
+        CHECK(trades[2].quantity == 2);
+    }
+    CHECK(engine.getOrderBook("X")->getLastPrice() == 102);
+    CHECK(engine.getUserOrders("stops").empty());
+}
@@ -0,0 +1,177 @@
+#include "TestHarness.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace DEX::tests {
+
+int& failures() {
+    static int count = 0;
+    return count;
+}
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+namespace {
+
+// TradeSink only refers to its callable, so this one has to outlive it
+const auto ignoreTrades = [](const Trade&) {};
+
+} // namespace
+
+const TradeSink kIgnoreTrades = ignoreTrades;
+
+PairSpec unitSpec() {
+    PairSpec spec;
+    spec.tickSize = 1;
+    spec.lotSize = 1;
+    return spec;
+}
+
+TempFile::TempFile(const std::string& name) : path("dex_tests_" + name) {
+    std::remove(path.c_str());
+}
+
+TempFile::~TempFile() {
+    std::remove(path.c_str());
+}
+
+Depth bidDepth(const OrderBook& book) {
+    Depth depth(4096);
+    depth.resize(book.getBidDepth(depth.data(), depth.size()));
+    return depth;
+}
+
+Depth askDepth(const OrderBook& book) {
+    Depth depth(4096);
+    depth.resize(book.getAskDepth(depth.data(), depth.size()));
+    return depth;
+}
+
+bool sameDepth(const Depth& a, const Depth& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].price != b[i].price || a[i].quantity != b[i].quantity ||
+            a[i].orderCount != b[i].orderCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameBooks(MatchingEngine& a, MatchingEngine& b) {
+    std::vector<std::string> pairs = a.getTradingPairs();
+    if (pairs != b.getTradingPairs()) {
+        return false;
+    }
+    for (const std::string& pair : pairs) {
+        const OrderBook& left = *a.getOrderBook(pair);
+        const OrderBook& right = *b.getOrderBook(pair);
+        if (!sameDepth(bidDepth(left), bidDepth(right)) || !sameDepth(askDepth(left), askDepth(right)) ||
+            left.getOrderCount() != right.getOrderCount() || left.getLastPrice() != right.getLastPrice()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameTrades(const std::vector<Trade>& a, const std::vector<Trade>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].buyOrderId != b[i].buyOrderId || a[i].sellOrderId != b[i].sellOrderId ||
+            a[i].price != b[i].price || a[i].quantity != b[i].quantity) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OrderStatus statusOf(const MatchingEngine& engine, uint64_t orderId, const std::string& pair) {
+    Order order(0, 0, 0, OrderSide::BUY, OrderType::LIMIT, 0, 0);
+    if (!engine.getOrder(orderId, pair, order)) {
+        throw std::runtime_error("Order " + std::to_string(orderId) + " not found");
+    }
+    return order.status;
+}
+
+std::vector<uint64_t> tradeFlow(MatchingEngine& engine, Clock::time_point start, uint32_t seed) {
+    std::vector<uint64_t> ids;
+    uint32_t state = seed;
+    auto next = [&state](uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    };
+
+    for (int step = 0; step < 3000; ++step) {
+        const char* pair = next(2) ? "A" : "B";
+        uint32_t kind = next(10);
+        if (step == 1500) {
+            engine.expireOrders(start + std::chrono::seconds(30));
+        }
+
+        if (kind < 6 || ids.empty()) {
+            OrderSide side = next(2) ? OrderSide::BUY : OrderSide::SELL;
+            double price = 1000.0 + next(41) - 20 + (side == OrderSide::BUY ? -3 : 3);
+            bool gtd = next(4) == 0;
+            TimeInForce timeInForce = gtd ? TimeInForce::GTD : next(8) == 0 ? TimeInForce::IOC : TimeInForce::GTC;
+            OrderType type = next(15) == 0 ? OrderType::MARKET : OrderType::LIMIT;
+            OrderResult result = engine.submitOrder("u" + std::to_string(next(20)), pair, side, type,
+                                                    type == OrderType::MARKET ? 0.0 : price,
+                                                    1.0 + next(20), kIgnoreTrades, timeInForce,
+                                                    gtd ? start + std::chrono::seconds(1 + next(60)) : Clock::time_point{});
+            ids.push_back(result.orderId);
+        } else if (kind < 8) {
+            std::vector<Trade> trades;
+            engine.amendOrder(ids[next(static_cast<uint32_t>(ids.size()))], pair,
+                              1000.0 + next(41) - 20, 1.0 + next(20), trades);
+        } else {
+            engine.cancelOrder(ids[next(static_cast<uint32_t>(ids.size()))], pair);
+        }
+    }
+    return ids;
+}
+
+} // namespace DEX::tests
+
+int main(int argc, char** argv) {
+    using namespace DEX::tests;
+
+    // In name order, whatever order the files were linked in
+    std::vector<TestCase> tests = registry();
+    std::sort(tests.begin(), tests.end(),
+              [](const TestCase& a, const TestCase& b) { return std::strcmp(a.name, b.name) < 0; });
+
+    int run = 0;
+    for (const TestCase& test : tests) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || std::strcmp(argv[i], test.name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+
+        int before = failures();
+        try {
+            test.run();
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s: unexpected exception: %s\n", test.name, e.what());
+            ++failures();
+        }
+        std::printf("%-24s %s\n", test.name, failures() == before ? "ok" : "FAILED");
+        ++run;
+    }
+
+    if (run == 0) {
+        std::fprintf(stderr, "No test matches\n");
+        return 1;
+    }
+    return failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../include/MatchingEngine.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Minimal test harness for dex_tests: each *Test.cpp file defines its
+// cases with TEST, and TestHarness.cpp runs them all, or only those named
+// on the command line.
+
+namespace DEX::tests {
+
+// Failed checks so far, over every test
+int& failures();
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& registry();
+
+struct Registration {
+    Registration(const char* name, void (*run)()) { registry().push_back(TestCase{name, run}); }
+};
+
+// Engine fixtures shared by the test files
+
+using Clock = std::chrono::system_clock;
+using Depth = std::vector<DepthLevel>;
+
+extern const TradeSink kIgnoreTrades;
+
+// Whole ticks and lots, so prices and quantities read the same either way
+PairSpec unitSpec();
+
+// A file the test writes, removed before and after use
+struct TempFile {
+    std::string path;
+
+    explicit TempFile(const std::string& name);
+    ~TempFile();
+};
+
+Depth bidDepth(const OrderBook& book);
+Depth askDepth(const OrderBook& book);
+bool sameDepth(const Depth& a, const Depth& b);
+
+// Same pairs with the same levels, open order count and last price
+bool sameBooks(MatchingEngine& a, MatchingEngine& b);
+
+bool sameTrades(const std::vector<Trade>& a, const std::vector<Trade>& b);
+
+// Status of an open or recently retired order; throws if it isn't known
+OrderStatus statusOf(const MatchingEngine& engine, uint64_t orderId, const std::string& pair);
+
+// A fixed mix of limit, market, IOC and GTD orders, amends and cancels on
+// pairs "A" and "B", with GTD orders expiring halfway. Returns the order
+// IDs used.
+std::vector<uint64_t> tradeFlow(MatchingEngine& engine, Clock::time_point start, uint32_t seed);
+
+} // namespace DEX::tests
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++::DEX::tests::failures();                                                     \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_THROWS(expression, exception)                 \
+    do {                                                    \
+        bool thrown = false;                                \
+        try {                                               \
+            expression;                                     \
+        } catch (const exception&) {                        \
+            thrown = true;                                  \
+        }                                                   \
+        CHECK(thrown && #expression " throws " #exception); \
+    } while (0)
+
+// Define a test case, run as dex_tests <name>
+#define TEST(name)                                                                       \
+    static void name##Test();                                                            \
+    static const ::DEX::tests::Registration name##Registration(#name, name##Test);      \
+    static void name##Test()
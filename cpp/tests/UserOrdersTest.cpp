@@ -0,0 +1,85 @@
+#include "TestHarness.hpp"
+#include <algorithm>
+
+using namespace DEX;
+using namespace DEX::tests;
+
+namespace {
+
+std::vector<uint64_t> idsOf(const std::vector<Order>& orders) {
+    std::vector<uint64_t> ids;
+    for (const Order& order : orders) {
+        ids.push_back(order.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+TEST(user_orders) {
+    MatchingEngine engine;
+    PairId a = engine.addTradingPair("A", unitSpec());
+    PairId b = engine.addTradingPair("B", unitSpec());
+
+    uint64_t a1 = engine.submitOrder("alice", "A", OrderSide::BUY, OrderType::LIMIT, 10, 2, kIgnoreTrades).orderId;
+    uint64_t a2 = engine.submitOrder("alice", "A", OrderSide::SELL, OrderType::LIMIT, 20, 1, kIgnoreTrades).orderId;
+    uint64_t b1 = engine.submitOrder("alice", "B", OrderSide::BUY, OrderType::LIMIT, 5, 1, kIgnoreTrades).orderId;
+    uint64_t bob = engine.submitOrder("bob", "A", OrderSide::BUY, OrderType::LIMIT, 9, 1, kIgnoreTrades).orderId;
+
+    CHECK(idsOf(engine.getUserOrders("alice", "A")) == (std::vector<uint64_t>{a1, a2}));
+    CHECK(idsOf(engine.getUserOrders("bob", "A")) == (std::vector<uint64_t>{bob}));
+    CHECK(engine.getUserOrders("carol", "A").empty());
+
+    // Across pairs, each order says which book it rests in
+    std::vector<Order> all = engine.getUserOrders("alice");
+    CHECK(idsOf(all) == (std::vector<uint64_t>{a1, a2, b1}));
+    for (const Order& order : all) {
+        CHECK(order.pairId == (order.id == b1 ? b : a));
+        CHECK(engine.getUserName(order.userId) == "alice");
+    }
+
+    // Partial fills stay listed with their progress; full fills and cancels leave
+    engine.submitOrder("bob", "A", OrderSide::SELL, OrderType::MARKET, 0, 1, kIgnoreTrades);
+    std::vector<Order> partial = engine.getUserOrders("alice", "A");
+    CHECK(idsOf(partial) == (std::vector<uint64_t>{a1, a2}));
+    for (const Order& order : partial) {
+        if (order.id == a1) CHECK(order.filledQuantity == 1);
+    }
+    engine.submitOrder("bob", "A", OrderSide::SELL, OrderType::MARKET, 0, 1, kIgnoreTrades);
+    CHECK(engine.cancelOrder(a2, a));
+    CHECK(engine.cancelOrder(b1, b));
+    CHECK(engine.getUserOrders("alice").empty());
+
+    // Once a user's list has emptied, new orders show up again
+    uint64_t again = engine.submitOrder("alice", "A", OrderSide::SELL, OrderType::LIMIT, 30, 1, kIgnoreTrades).orderId;
+    CHECK(idsOf(engine.getUserOrders("alice")) == (std::vector<uint64_t>{again}));
+    CHECK(idsOf(engine.getUserOrders("bob", "A")) == (std::vector<uint64_t>{bob}));
+}
+
+TEST(user_orders_reuse) {
+    if constexpr (!kStatsEnabled) {
+        return;
+    }
+
+    BookMemory arena;
+    arena.arena.prefault = true;
+    for (const BookMemory& memory : {BookMemory{}, arena}) {
+        OrderBook book("A", unitSpec(), 0, memory);
+        uint64_t id = 1;
+
+        // A user whose only order fills and who then rests again costs
+        // nothing once the book has seen them
+        auto roundTrip = [&] {
+            book.addOrder(NewOrder{id++, 1, OrderSide::BUY, OrderType::LIMIT, 10, 1}, kIgnoreTrades);
+            book.addOrder(NewOrder{id++, 2, OrderSide::SELL, OrderType::LIMIT, 10, 1}, kIgnoreTrades);
+        };
+        roundTrip();
+        uint64_t before = threadAllocations();
+        for (int i = 0; i < 100; ++i) {
+            roundTrip();
+        }
+        CHECK(threadAllocations() == before);
+        CHECK(book.getUserOrders(1).empty());
+    }
+}